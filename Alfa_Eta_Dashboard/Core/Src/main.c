@@ -23,6 +23,7 @@
 /* USER CODE BEGIN Includes */
 #include "dashboard_controls.h"
 #include "geo_to_pixel.h"
+#include "gps_config.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -43,9 +44,12 @@
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart2;
 UART_HandleTypeDef huart3;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
+DMA_HandleTypeDef hdma_usart3_rx;
 
 /* USER CODE BEGIN PV */
-int count = 0; // Used to simulate changing speed and toggle signals
+int count = 0; // Used to simulate changing speed and the turn-signal switch
 
 // Runtime variables representing vehicle data
 int speed,
@@ -94,6 +98,7 @@ NEX_Data dashboardValues = {
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_USART3_UART_Init(void);
 /* USER CODE BEGIN PFP */
@@ -135,6 +140,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_USART3_UART_Init();
   /* USER CODE BEGIN 2 */
@@ -142,10 +148,20 @@ int main(void)
   // IMPOTANT : Call after UART initialization (e.g., MX_USARTX_UART_Init())
 
   // Initialize the Nextion dashboard interface with UART and runtime data
-  NEX_Init(&huart2, &dashboardValues);
+  if (NEX_Init(&huart2, &dashboardValues) == HAL_OK)
+  {
+#if NEX_BAUD_UPGRADE
+	  // Optional: move the display link to the fastest rate both sides accept
+	  NEX_Upgrade_Baud(NEX_MAX_BAUD_RATE, 200);
+#endif
+  }
 
   // Initialize the GPS-to-pixel conversion module for map tracking
-  Geo_To_Pixel_Init(&huart3, &MapData);
+  if (Geo_To_Pixel_Init(&huart3, &MapData) == HAL_OK)
+  {
+	  // Optional: 10 Hz fixes, only the used sentences, 115200 baud (u-blox receivers)
+	  GPS_Config_Apply(&huart3, GPS_CONFIG_BAUD_RATE, GPS_CONFIG_PERIOD_MS, GPS_CONFIG_ACK_TIMEOUT_MS);
+  }
 
 
 
@@ -178,7 +194,13 @@ int main(void)
 	  speed = count;
 	  count = count+1;
 
+#if NEX_DISPLAY_BLINK
+	  // Simulate the turn-signal switch (hazard lights for half of the cycle);
+	  // the display flashes the icons itself
+	  if(count < 25)
+#else
 	  if(count%2 == 0)
+#endif
 	  {
 		  signalLeft = NEX_STATE_ON;
 		  signalRight = NEX_STATE_ON;
@@ -316,6 +338,28 @@ static void MX_USART3_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream1_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -339,6 +383,52 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+  * @brief  UART transmit complete callback.
+  *         Hands the finished DMA chunk back to the Nextion TX queue.
+  * @param  huart: UART handle that completed its transfer.
+  * @retval None
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  NEX_Link_TxCplt_Callback(huart);
+}
+
+/**
+  * @brief  UART error callback.
+  *         Lets the Nextion TX queue and the Nextion / GPS receivers recover
+  *         from an aborted DMA transfer.
+  * @param  huart: UART handle that reported the error.
+  * @retval None
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART3)
+  {
+    GPS_Rx_Error_Callback(huart);
+    return;
+  }
+
+  NEX_Link_Error_Callback(huart);
+  NEX_Rx_Error_Callback(huart);
+}
+
+/**
+  * @brief  UART reception event callback (IDLE line, half / full DMA buffer).
+  *         Feeds the received Nextion bytes to the response parser and
+  *         publishes the received GPS bytes to the sentence reader.
+  * @param  huart: UART handle that reported the event.
+  * @param  Size:  DMA write position in the reception buffer.
+  * @retval None
+  */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  if (huart->Instance == USART3)
+    GPS_Rx_Event_Callback(huart, Size);
+  else
+    NEX_Rx_Event_Callback(huart, Size);
+}
+
 /* USER CODE END 4 */
 
 /**
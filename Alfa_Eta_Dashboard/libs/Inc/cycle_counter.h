@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file           : cycle_counter.h
+ * @brief          : DWT cycle counter helpers for on-target benchmarks
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Thin wrappers around the Cortex-M4 DWT->CYCCNT register. They are only
+ * used by the benchmark functions compiled in with DASHBOARD_ENABLE_BENCHMARK,
+ * and cost nothing in a normal build.
+ *
+ * Cycle counts are CPU clock cycles (HCLK). At the default 8 MHz HSE clock
+ * one cycle is 125 ns.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef CYCLE_COUNTER
+#define CYCLE_COUNTER
+
+#include "stm32f4xx_hal.h"
+
+/**
+  * @brief  Enables the DWT cycle counter and resets it to zero.
+  * @retval None
+  */
+static inline void Cycle_Counter_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+  * @brief  Returns the current value of the free-running cycle counter.
+  * @retval CPU cycles since Cycle_Counter_Init(), wrapping at 2^32.
+  */
+static inline uint32_t Cycle_Counter_Get(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif // CYCLE_COUNTER
@@ -17,6 +17,11 @@
  *   to ensure the UART handle is correctly initialized.
  * - The Nextion display must be configured to communicate at **115200 Baud Rate**.
  *   Make sure this setting matches both the UART peripheral and the Nextion editor config.
+ * - Commands are batched per refresh (nex_frame.h) and sent through the
+ *   DMA queue of nex_link.h, so the UART TX DMA stream and the UART TX
+ *   complete callback must be set up.
+ * - Responses are received by nex_rx.h, which needs the UART RX DMA stream
+ *   (circular) and the RX event callback.
  *
  * Failing to match the baud rate or calling initialization before UART setup
  * will cause communication failures or random garbage characters on screen.
@@ -36,8 +41,9 @@
 #include "stm32f4xx_hal.h"
 #include "geo_to_pixel.h"
 #include "mapping.h"
+#include "nex_frame.h"
+#include "nex_rx.h"
 #include <string.h>
-#include <stdio.h>
 
 #define NEX_SCREEN_SIZE_X 800  /*!< Width of the Nextion display in pixels */
 #define NEX_SCREEN_SIZE_Y 480  /*!< Height of the Nextion display in pixels */
@@ -50,6 +56,132 @@
 #define NEX_KW_PROGRESS_BAR_MIN_VAL 0         /*!< Minimum value for the power (kW) progress bar */
 #define NEX_KW_PROGRESS_BAR_MAX_VAL 5         /*!< Maximum value for the power (kW) progress bar */
 
+#define NEX_MAX_WIDGETS 64U   /*!< Capacity of the widget registry (multiple of 32) */
+
+#define NEX_WIDGET_SETTLE_MS 1000U   /*!< Default settle time of filtered widgets (settleMs = 0) */
+
+#define NEX_REFRESH_PERIOD_MS 300U   /*!< Default NEX_Refresh() call period used for the byte budget */
+
+#ifndef NEX_BAUD_UPGRADE
+#define NEX_BAUD_UPGRADE 0U                  /*!< 1: main.c calls NEX_Upgrade_Baud() after NEX_Init() */
+#endif
+#define NEX_MAX_BAUD_RATE 921600U            /*!< Highest rate tried by NEX_Upgrade_Baud() in main.c */
+#define NEX_BAUD_MAX_ERROR_PERMILLE 20U      /*!< Largest acceptable UART baud rate error (2.0 %) */
+#define NEX_BAUD_SWITCH_DELAY_MS 50U         /*!< Time given to the display to apply "baud=" */
+#define NEX_LINK_PROBE_MS 1000U              /*!< "sendme" interval while the link runs above its power-on rate */
+#define NEX_LINK_RECOVERY_TIMEOUT_MS 100U    /*!< Handshake wait per attempt while looking for the display */
+
+/**
+ * @brief With NEX_PACK_INDICATORS set, the six NEX_State indicators and the
+ *        gear are written as one "vInd.val=" command (NEX_INDICATOR_* bits)
+ *        instead of one "pXX.aph=" / "pGr.pic=" command each, so hazard
+ *        lights or the start-up state cost one command instead of seven.
+ *        A timer on the display page compares vInd with the value it last
+ *        applied and sets the icon alpha (0 / 127) and the gear picture
+ *        (N 14, D 13, R 15). The current HMI has neither the variable nor
+ *        the timer, so the default is 0.
+ */
+#ifndef NEX_PACK_INDICATORS
+#define NEX_PACK_INDICATORS 0U               /*!< 1: one "vInd.val=" bitmask, 0: one command per icon (current HMI) */
+#endif
+
+/**
+ * @brief With NEX_DISPLAY_BLINK set, signalLeft / signalRight are the
+ *        turn-signal switch position, not the lamp state. Only switch
+ *        transitions are sent (vInd bits 1 and 2, or "vSL.val=" / "vSR.val="
+ *        when unpacked) and the display timer tmBlk flashes the icons, so the
+ *        blink rate no longer depends on the main loop period. "tmBlk.tim="
+ *        is written after the handshake and after every display reboot. The
+ *        current HMI has no tmBlk or vSL / vSR, so the default is 0.
+ */
+#ifndef NEX_DISPLAY_BLINK
+#define NEX_DISPLAY_BLINK 0U                 /*!< 1: the display flashes the turn signals, 0: the MCU toggles them (current HMI) */
+#endif
+#define NEX_BLINK_PERIOD_MS 500U             /*!< Half period of the display-side turn signal blink */
+
+#define NEX_INDICATOR_HANDBRAKE   (1U << 0)  /*!< vInd bit: handbrake */
+#define NEX_INDICATOR_SIGNAL_L    (1U << 1)  /*!< vInd bit: left signal */
+#define NEX_INDICATOR_SIGNAL_R    (1U << 2)  /*!< vInd bit: right signal */
+#define NEX_INDICATOR_CONN_WARN   (1U << 3)  /*!< vInd bit: connection warning */
+#define NEX_INDICATOR_BATT_WARN   (1U << 4)  /*!< vInd bit: battery warning */
+#define NEX_INDICATOR_LIGHTS      (1U << 5)  /*!< vInd bit: lights */
+#define NEX_INDICATOR_GEAR_SHIFT  8U         /*!< Position of the NEX_Gears field in vInd */
+
+/**
+ * @brief Binary frame (NEX_Set_Binary_Mode()), one per refresh with a dirty widget:
+ *
+ *   0xA5 0x5A | count N | N x int16 little-endian, registry order | checksum
+ *
+ *        The checksum is the low byte of the sum of count and value bytes.
+ *        An HMI timer unpacks it from u[] / usize and applies the values in
+ *        registration order (see NEX_Bind()). Values are saturated to int16;
+ *        text widgets carry their intern ID, free-form text is packed as 0.
+ */
+#define NEX_BINARY_HEADER_0 0xA5U             /*!< First byte of a binary frame */
+#define NEX_BINARY_HEADER_1 0x5AU             /*!< Second byte of a binary frame */
+#define NEX_BINARY_OVERHEAD 4U                /*!< Header, count and checksum bytes */
+
+#define NEX_PAGE_DASHBOARD 0U                 /*!< Page of the standard widgets, shown after start-up */
+#define NEX_PAGE_GLOBAL 0xFFU                 /*!< Widget is sent regardless of the active page */
+
+#define NEX_MAX_WAVEFORMS 4U                  /*!< Capacity of the waveform channel table */
+#define NEX_WAVE_BUFFER_SIZE 64U              /*!< Pending samples per channel */
+#define NEX_WAVE_FLUSH_SAMPLES 32U            /*!< Pending samples that trigger an early flush */
+
+#ifndef NEX_HISTORY_GRAPH
+#define NEX_HISTORY_GRAPH 0U                  /*!< 1: register the speed / power history channels */
+#endif
+#define NEX_HISTORY_GRAPH_ID 20U              /*!< Component ID of the history waveform in the HMI */
+#define NEX_HISTORY_GRAPH_PAGE NEX_PAGE_DASHBOARD  /*!< Page of the history waveform */
+#define NEX_HISTORY_GRAPH_HEIGHT 100U         /*!< Height of the waveform in pixels */
+#define NEX_HISTORY_SAMPLE_MS 250U            /*!< 240 samples = one minute */
+#define NEX_HISTORY_FLUSH_MS 1000U            /*!< One addt transfer per channel per second */
+#define NEX_HISTORY_SPEED_MAX 80              /*!< Speed (km/h) at the top of the history graph */
+
+#define NEX_RESYNC_PERIOD_MS 5000U            /*!< Every widget is re-sent at least this often (0 = off) */
+
+#ifndef NEX_MAP_TRAIL
+#define NEX_MAP_TRAIL 0U                      /*!< 1: draw the driven-path trail from NEX_Bind() on */
+#endif
+#define NEX_TRAIL_REDRAW_MS 1000U             /*!< Shortest interval between full trail redraws */
+#define NEX_TRAIL_COLOR 2016U                 /*!< RGB565 line color (green) */
+
+/**
+ * @brief By default the map is the large picture pMap, moved with "pMap.x=" /
+ *        "pMap.y=", and every move repaints both the old and the new area.
+ *        With NEX_MAP_CROP set, one "xpic" copies the NEX_MAP_VIEW_* window
+ *        out of picture NEX_MAP_PICTURE, so only that window is repainted and
+ *        the HMI needs no pMap. The default window is what the moving picture
+ *        covers at every allowed offset, so both modes show the same area.
+ *        xpic paints over components; NEX_MAP_OVERLAY redraws the icon.
+ *        NEX_Benchmark_Map() compares the render time of both modes.
+ */
+#ifndef NEX_MAP_CROP
+#define NEX_MAP_CROP 0U                       /*!< 1: draw the map window with xpic, 0: move the pMap picture */
+#endif
+#define NEX_MAP_PICTURE 0U                    /*!< Picture resource ID of the whole map (NEX_MAP_CROP) */
+#define NEX_MAP_OVERLAY "ref zIc"             /*!< Redraws the icon over the cropped map (NEX_MAP_CROP) */
+#define NEX_MAP_VIEW_X 450                    /*!< Map window on screen: left edge */
+#define NEX_MAP_VIEW_Y 0                      /*!< Map window on screen: top edge */
+#define NEX_MAP_VIEW_W 350                    /*!< Map window width in pixels */
+#define NEX_MAP_VIEW_H 480                    /*!< Map window height in pixels */
+
+/**
+ * @brief A pending update is only the widget's dirty bit and the value is read
+ *        when the frame is built. While more than NEX_COALESCE_BACKLOG bytes
+ *        are queued no frame is built, so on a saturated link newer values
+ *        overwrite pending ones and at most one update per widget is pending.
+ */
+#define NEX_COALESCE_BACKLOG 0U              /*!< Queued bytes above which NEX_Refresh() builds no frame */
+
+/**
+ * @brief Each serial buffer overflow reported by the display (nex_rx.h)
+ *        halves the frame budget and marks every widget dirty, since the lost
+ *        commands are unknown.
+ */
+#define NEX_THROTTLE_MAX_SHIFT 3U            /*!< Budget is divided by at most 2^3 after overflows */
+#define NEX_THROTTLE_RECOVERY_FRAMES 10U     /*!< Clean refreshes before the budget is doubled again */
+
 
 /**
  * @brief Enum for selecting gear states via dashboard.
@@ -87,6 +219,29 @@ typedef enum {
     NEX_STATE_ON  = 0x01U    /*!< Feature is active or turned on */
 } NEX_State;
 
+/**
+ * @brief Refresh priority class of a widget.
+ *
+ * Dirty widgets are sent in the order CRITICAL, HIGH, NORMAL, LOW. The
+ * zero value is NORMAL so a descriptor without a priority gets the default.
+ */
+typedef enum {
+    NEX_PRIORITY_NORMAL   = 0x00U,  /*!< Regular read-outs (battery level, lap) */
+    NEX_PRIORITY_LOW      = 0x01U,  /*!< Slow diagnostics (voltages, temperatures) */
+    NEX_PRIORITY_HIGH     = 0x02U,  /*!< Driving information (speed, gear, power) */
+    NEX_PRIORITY_CRITICAL = 0x03U,  /*!< Safety indicators (handbrake, signals, warnings) */
+    NEX_PRIORITY_COUNT    = 0x04U   /*!< Number of priority classes */
+} NEX_Priority;
+
+/**
+ * @brief How a widget value is written to the display.
+ */
+typedef enum {
+    NEX_FORMAT_NUMBER = 0x00U,  /*!< "<prefix><display value>" */
+    NEX_FORMAT_TEXT   = 0x01U,  /*!< <prefix>"<text>", from strings[value] or the source buffer */
+    NEX_FORMAT_CROP   = 0x02U   /*!< "<prefix><x0>,<y0>,<picture>" and overlay, display = x0 << 16 | y0 */
+} NEX_Format;
+
 /**
   * @brief  Structure holding pointers to all dashboard variables.
   *         Used for accessing real-time data.
@@ -102,7 +257,7 @@ typedef struct {
     MapOffset *mapData;      /*!< Map informations */
     NEX_Gears *gear;               /*!< Gear position: 0=N, 1=D, 2=R */
     NEX_State *handbrake;          /*!< Handbrake: 0=Off, 1=On */
-    NEX_State *signalLeft;         /*!< Left signal: 0/1 */
+    NEX_State *signalLeft;         /*!< Left signal: 0/1 (switch position with NEX_DISPLAY_BLINK) */
     NEX_State *signalRight;        /*!< Right signal: 0/1 */
     NEX_State *connWarn;           /*!< Connection warning: 0/1 */
     NEX_State *battWarn;           /*!< Battery warning: 0/1 */
@@ -111,26 +266,157 @@ typedef struct {
 
 
 /**
-  * @brief  Structure used to cache previous values of dashboard data.
-  *         Useful for detecting changes.
+  * @brief  Widget descriptor, forward-declared for the encoder signature.
+  */
+typedef struct NEX_WidgetConfig NEX_WidgetConfig;
+
+/**
+  * @brief  Reads the current value of a widget.
+  * @param  source: Source pointer stored in the widget configuration.
+  * @retval Current value, compared against the last value sent.
+  */
+typedef int32_t (*NEX_Source)(const void *source);
+
+/**
+  * @brief  Converts a source value into the value written to the widget.
+  * @param  widget:  Configuration of the widget being sent.
+  * @param  value:   Value returned by the widget source.
+  * @param  display: Receives the attribute value, e.g. a picture ID.
+  * @retval HAL_OK on success, HAL_ERROR if the value cannot be displayed.
+  * @note   The library writes "<prefix><display>" in ASCII mode and packs
+  *         display into the frame in binary mode.
+  */
+typedef HAL_StatusTypeDef (*NEX_Encoder)(const NEX_WidgetConfig *widget, int32_t value, int32_t *display);
+
+/**
+  * @brief  Descriptor of one display widget.
+  *
+  * A change within the deadband or sooner than minIntervalMs after the last
+  * send is held back, and the value left is sent once it has been stable for
+  * settleMs, so the display always converges to the exact source value.
+  *
+  * Text widgets send a quoted, escaped string. Constant messages live in a
+  * flash table and the source holds the index, so only the index is compared.
+  * Free-form text uses NEX_Read_Text, which compares a hash of the buffer.
+  * Text widgets should not use a deadband.
+  *
+  * Example, a number box showing a cell voltage:
+  * @code
+  * NEX_WidgetConfig cell = {
+  *     .prefix = NEX_PREFIX("xC1.val="),
+  *     .read   = NEX_Read_Int,
+  *     .source = &cellVoltage[0],
+  *     .encode = NEX_Encode_Number,
+  * };
+  * @endcode
+  *
+  * A fault message picked from a flash-resident table by a fault index:
+  * @code
+  * static const char *const faultTexts[] = { "", "BMS OVERTEMP", "MOTOR FAULT" };
+  * NEX_WidgetConfig fault = {
+  *     .prefix      = NEX_PREFIX("tFlt.txt="),
+  *     .read        = NEX_Read_Int,
+  *     .source      = &faultIndex,
+  *     .encode      = NEX_Encode_Text,
+  *     .format      = NEX_FORMAT_TEXT,
+  *     .strings     = faultTexts,
+  *     .stringCount = 3,
+  * };
+  * @endcode
+  */
+struct NEX_WidgetConfig {
+    NEX_Prefix     prefix;       /*!< Command prefix, e.g. NEX_PREFIX("nSd.val=") */
+    NEX_Source     read;         /*!< Reads the current value from source */
+    const void    *source;       /*!< Address of the runtime value */
+    NEX_Encoder    encode;       /*!< Converts the value for the display */
+    int32_t        inMin;        /*!< Scaling: input range minimum (NEX_Encode_Scaled) */
+    int32_t        inMax;        /*!< Scaling: input range maximum (NEX_Encode_Scaled) */
+    int32_t        outMin;       /*!< Scaling: display value for inMin (NEX_Encode_Scaled) */
+    int32_t        outMax;       /*!< Scaling: display value for inMax (NEX_Encode_Scaled) */
+    const int16_t *lookup;       /*!< Display value per source value (NEX_Encode_Lookup) */
+    uint8_t        lookupSize;   /*!< Number of entries in lookup */
+    uint16_t       deadband;     /*!< Changes of at most this many LSB are held back (0 = off) */
+    uint16_t       minIntervalMs;/*!< Minimum time between two sends in ms (0 = off) */
+    uint16_t       settleMs;     /*!< A held-back value is sent after being stable this long
+                                      (0 = NEX_WIDGET_SETTLE_MS) */
+    NEX_Priority   priority;     /*!< Refresh priority class */
+    uint8_t        page;         /*!< Display page ID, or NEX_PAGE_GLOBAL */
+    NEX_Format     format;       /*!< Number or text command */
+    const char *const *strings;  /*!< Text: intern table indexed by the value, NULL = source is the text */
+    uint8_t        stringCount;  /*!< Number of entries in strings */
+    int16_t        picture;      /*!< Crop: picture resource the window is copied from */
+    const char    *overlay;      /*!< Crop: command sent right after, e.g. "ref zIc", or NULL */
+};
+
+/**
+  * @brief  Update counters of one widget.
   */
 typedef struct {
-    int speed;
-    int batteryValue;
-    int powerKW;
-    int packVoltage;
-    int maxVoltage;
-    int minVoltage;
-    int batteryTemp;
-    MapOffset mapData;
-    NEX_Gears gear;
-    NEX_State handbrake;
-    NEX_State signalLeft;
-    NEX_State signalRight;
-    NEX_State connWarn;
-    NEX_State battWarn;
-    NEX_State lights;
-} NEX_CachedData;
+    uint32_t sent;           /*!< Updates appended to a frame */
+    uint32_t suppressed;     /*!< Refreshes in which a change was held back by the filter */
+    uint32_t coalesced;      /*!< Pending updates overwritten by a newer value before sending */
+    uint32_t resynced;       /*!< Unchanged values re-sent by the background sweep */
+    uint32_t encodeErrors;   /*!< Values the encoder rejected; dropped, not retried */
+} NEX_WidgetStats;
+
+/**
+  * @brief  Descriptor of one waveform channel.
+  */
+typedef struct {
+    uint8_t     objectId;    /*!< Component ID of the waveform (not its name) */
+    uint8_t     channel;     /*!< Waveform channel, 0..3 */
+    uint8_t     page;        /*!< Page of the waveform, or NEX_PAGE_GLOBAL */
+    uint8_t     height;      /*!< Sample value for inMax (waveform height, at most 255) */
+    NEX_Source  read;        /*!< Reads the current value from source */
+    const void *source;      /*!< Address of the runtime value */
+    int32_t     inMin;       /*!< Value drawn at the bottom */
+    int32_t     inMax;       /*!< Value drawn at the top */
+    uint16_t    sampleMs;    /*!< Sample period in ms */
+    uint16_t    flushMs;     /*!< Longest time samples wait before a transfer */
+} NEX_WaveformConfig;
+
+/**
+  * @brief  Waveform transfer counters, all channels together.
+  */
+typedef struct {
+    uint32_t samples;        /*!< Samples taken */
+    uint32_t dropped;        /*!< Samples lost to a full ring */
+    uint32_t transfers;      /*!< Completed addt transfers */
+    uint32_t bytes;          /*!< Bytes sent for them, commands included */
+    uint32_t refused;        /*!< Transfers the display refused (invalid component or variable) */
+} NEX_WaveformStats;
+
+/**
+  * @brief  Wire size of the ASCII and binary encodings, for comparison.
+  */
+typedef struct {
+    uint32_t frames;         /*!< Refreshes that sent something */
+    uint32_t asciiBytes;     /*!< Bytes of the ASCII commands for those refreshes */
+    uint32_t binaryBytes;    /*!< Bytes of the binary frames for those refreshes */
+    uint16_t asciiAllDirty;  /*!< ASCII size of one all-dirty refresh, current values */
+    uint16_t binaryFrame;    /*!< Size of one binary frame (fixed) */
+} NEX_WireStats;
+
+/**
+  * @brief  Display reboot recovery counters.
+  */
+typedef struct {
+    uint32_t reboots;        /*!< Start-up / ready messages received after NEX_Bind() */
+    uint32_t lastRestoreMs;  /*!< Reboot message to fully replayed screen, last reboot */
+    uint32_t worstRestoreMs; /*!< Largest lastRestoreMs */
+    uint32_t baudFallbacks;  /*!< Reboots found at the power-on rate after a baud rate upgrade */
+    uint8_t restoring;       /*!< 1 while a replay is in progress */
+} NEX_RecoveryStats;
+
+/**
+  * @brief  Scheduling counters of one priority class.
+  */
+typedef struct {
+    uint32_t sent;           /*!< Updates of this class appended to a frame */
+    uint32_t deferred;       /*!< Refreshes in which a dirty widget of this class did not fit */
+    uint32_t lastLatencyMs;  /*!< Time from change detection to queueing, last update */
+    uint32_t worstLatencyMs; /*!< Largest lastLatencyMs since the counters were reset */
+} NEX_PriorityStats;
 
 
 /*--------------------- Function Prototypes ---------------------*/
@@ -161,12 +447,18 @@ HAL_StatusTypeDef NEX_Bind(UART_HandleTypeDef *uart, NEX_Data *data);
 /**
   * @brief  Refreshes the dashboard screen with the latest runtime data.
   * @retval HAL_StatusTypeDef
-  *         - HAL_OK: Transmission successful
-  *         - HAL_ERROR: UART transmission failed
+  *         - HAL_OK: All changed values were queued
+  *         - HAL_BUSY: The previous frame is still being sent, or the frame
+  *           budget was used up; changes stay pending
+  *         - HAL_ERROR: TX queue overflow or value out of range
   *
-  * This function checks each field of the dashboard data and compares it with
-  * previously sent values. Only changed values are transmitted to minimize
-  * UART load and avoid redundant updates on the Nextion display.
+  * Every registered widget is compared with the value last sent and changed
+  * widgets are marked in a dirty bitmap. Only the marked widgets are encoded,
+  * highest priority class first and up to the per-frame byte budget.
+  * A widget that could not be queued stays dirty and is retried next call.
+  * All changed values are assembled into one frame and queued in a single write;
+  * the DMA sends it in the background. Use NEX_Frame_Get_Info() for the frame size
+  * in bytes when sizing the refresh period against the link budget.
   *
   * Should be called periodically in the main loop or task scheduler.
   */
@@ -181,8 +473,261 @@ HAL_StatusTypeDef NEX_Refresh(void);
   * @param  timeout: Maximum time to wait (in milliseconds) for a response per attempt.
   *
   * @retval HAL_OK    If handshake is successful.
+  * @retval HAL_BUSY  If a waveform transfer is in progress; nothing was sent.
   * @retval HAL_ERROR If no valid response is received within given retries.
   */
 HAL_StatusTypeDef NEX_Handshake(uint32_t timeout);
 
+/**
+  * @brief  Switches the display link to the fastest verified baud rate.
+  * @param  maxBaudRate: Upper limit, e.g. NEX_MAX_BAUD_RATE.
+  * @param  timeout:     Receive timeout per handshake attempt while verifying.
+  * @retval HAL_StatusTypeDef
+  *         - HAL_OK: The link runs at a faster rate (see huart->Init.BaudRate).
+  *         - HAL_ERROR: No faster rate worked; the link is back at the original rate.
+  *         - HAL_TIMEOUT: The display no longer answers at the original rate either.
+  *         - HAL_BUSY: A waveform transfer is in progress; nothing was sent.
+  * @note   Call after a successful NEX_Init(). Blocks while verifying.
+  *         The byte budget of NEX_Refresh() is updated for the new rate.
+  *
+  * Each faster rate is set with "baud=" and verified with a fresh "OK"/"con=1"
+  * exchange. Rates the UART cannot generate within NEX_BAUD_MAX_ERROR_PERMILLE
+  * are skipped; with the current 8 MHz APB1 clock 256000 (0.8 % error) is the
+  * fastest usable rate. "baud=" is not persistent, see NEX_Get_Recovery_Stats().
+  */
+HAL_StatusTypeDef NEX_Upgrade_Baud(uint32_t maxBaudRate, uint32_t timeout);
+
+/**
+  * @brief  Adds a widget to the registry.
+  * @param  config: Widget descriptor; it is copied, so it may be a local variable.
+  * @param  id:     Receives the widget index (may be NULL).
+  * @retval HAL_OK on success, HAL_ERROR if the descriptor is incomplete or the
+  *         registry is full (NEX_MAX_WIDGETS).
+  * @note   A new widget is marked dirty, so its value is sent on the next refresh.
+  *         NEX_Bind() registers the standard widgets from NEX_Data.
+  */
+HAL_StatusTypeDef NEX_Register_Widget(const NEX_WidgetConfig *config, uint8_t *id);
+
+/**
+  * @brief  Forces a widget to be sent on the next refresh.
+  * @param  id: Widget index returned by NEX_Register_Widget().
+  */
+void NEX_Mark_Dirty(uint8_t id);
+
+/**
+  * @brief  Copies the update counters of a widget.
+  * @param  id:    Widget index returned by NEX_Register_Widget().
+  * @param  stats: Destination structure.
+  * @retval HAL_OK on success, HAL_ERROR if id is not registered or stats is NULL.
+  */
+HAL_StatusTypeDef NEX_Get_Widget_Stats(uint8_t id, NEX_WidgetStats *stats);
+
+/**
+  * @brief  Sets the NEX_Refresh() period used to derive the per-frame byte budget.
+  * @param  periodMs: Time between two NEX_Refresh() calls in milliseconds.
+  * @retval HAL_OK on success, HAL_ERROR if periodMs is 0 or no UART is bound.
+  * @note   The budget is baud / 10 * periodMs / 1000 bytes, capped by the frame
+  *         buffer. NEX_Bind() uses NEX_REFRESH_PERIOD_MS.
+  */
+HAL_StatusTypeDef NEX_Set_Refresh_Period(uint32_t periodMs);
+
+/**
+  * @brief  Sets the bound within which every visible widget is re-sent.
+  * @param  periodMs: Resync period in milliseconds, 0 disables the sweep.
+  * @note   NEX_Bind() uses NEX_RESYNC_PERIOD_MS.
+  *
+  * The cache only knows what was sent, so a corrupted byte would leave a
+  * widget wrong until its value changes. The budget left after the dirty
+  * widgets re-sends a few visible widgets round-robin, enough that each one is
+  * repeated within the period. ASCII mode only; binary frames carry every value.
+  */
+void NEX_Set_Resync_Period(uint32_t periodMs);
+
+/**
+  * @brief  Returns the current per-frame byte budget.
+  */
+uint16_t NEX_Get_Frame_Budget(void);
+
+/**
+  * @brief  Copies the scheduling counters of a priority class.
+  * @param  priority: Priority class.
+  * @param  stats:    Destination structure.
+  * @retval HAL_OK on success, HAL_ERROR on an invalid class or NULL stats.
+  * @note   The worst latency shows how long a class waits behind the budget.
+  */
+HAL_StatusTypeDef NEX_Get_Priority_Stats(NEX_Priority priority, NEX_PriorityStats *stats);
+
+/**
+  * @brief  Clears the scheduling counters of all priority classes.
+  */
+void NEX_Reset_Priority_Stats(void);
+
+/**
+  * @brief  Copies the display reboot recovery counters.
+  * @param  stats: Destination structure.
+  *
+  * On the start-up message (00 00 00) or "ready" (0x88) "con=1" is queued
+  * again and every widget is marked dirty, so the normal scheduler replays
+  * the state within the budget instead of in one blocking burst.
+  *
+  * After NEX_Upgrade_Baud() a rebooted display answers at its power-on rate,
+  * which shows up as framing errors or an unanswered "sendme" probe (every
+  * NEX_LINK_PROBE_MS). The link is then checked at the upgraded rate and at
+  * the power-on rate; found at the latter, the display is treated as rebooted
+  * and upgraded again. This blocks NEX_Refresh() for up to
+  * 2 x NEX_HANDSHAKE_ATTEMPTS x NEX_LINK_RECOVERY_TIMEOUT_MS.
+  */
+void NEX_Get_Recovery_Stats(NEX_RecoveryStats *stats);
+
+/**
+  * @brief  Adds a waveform channel fed by the addt bulk transfer.
+  * @param  config: Channel descriptor, copied.
+  * @retval HAL_OK on success, HAL_ERROR if the table is full or the descriptor is invalid.
+  *
+  * The source is sampled every sampleMs into a ring, scaled to 0..height.
+  * Every flushMs, or at NEX_WAVE_FLUSH_SAMPLES, the samples go out in one
+  * "addt <id>,<channel>,<n>" transfer: after the display answers 0xFE the n
+  * raw bytes follow. The display would take any command as sample data until
+  * then, so nothing else is sent meanwhile: NEX_Refresh() and the other
+  * functions that write to the display return HAL_BUSY until 0xFE arrives.
+  * The transfer is dropped if the display refuses it (invalid component or
+  * variable); after a line error the samples are sent without waiting, since
+  * the 0xFE may have been lost. A full ring drops its oldest sample, or the
+  * newest during a transfer of that channel. Hidden pages keep sampling;
+  * transfers pause in binary mode.
+  */
+HAL_StatusTypeDef NEX_Register_Waveform(const NEX_WaveformConfig *config);
+
+/**
+  * @brief  Copies the waveform transfer counters.
+  * @param  stats: Destination structure.
+  */
+void NEX_Get_Waveform_Stats(NEX_WaveformStats *stats);
+
+/**
+  * @brief  Shows a display page and pushes all widgets registered for it.
+  * @param  page: Page ID.
+  * @retval HAL_OK if "page <id>" was queued, HAL_BUSY during a waveform
+  *         transfer, HAL_ERROR if the queue is full, the library is not bound
+  *         or the display is in binary mode.
+  *
+  * Only widgets of the active page (or NEX_PAGE_GLOBAL) are sent; others just
+  * stay dirty. A page change made on the display is picked up from its
+  * "sendme" report (0x66, sendme in the page's preinitialize event). Either
+  * way every widget of the new page is pushed, because the display reloads
+  * the page with its design-time values.
+  */
+HAL_StatusTypeDef NEX_Show_Page(uint8_t page);
+
+/**
+  * @brief  Returns the page the library currently sends widgets for.
+  */
+uint8_t NEX_Get_Active_Page(void);
+
+/**
+  * @brief  Enables or disables ref_stop / ref_star around each ASCII frame.
+  * @param  enable: 1 to render each refresh at once, 0 to redraw per command.
+  * @note   The display then redraws once per refresh, so pMap.x and pMap.y
+  *         move the map in one step. See NEX_Benchmark_Render().
+  */
+void NEX_Set_Atomic_Frames(uint8_t enable);
+
+/**
+  * @brief  Enables or disables the driven-path trail over the map.
+  * @param  enable: 1 to draw the trail, 0 to erase it and stop drawing.
+  * @note   NEX_Bind() uses NEX_MAP_TRAIL.
+  *
+  * The lap path from map_trail.h is drawn with "line" commands clipped to
+  * NEX_MAP_VIEW_*. Lines are not display objects and every map move erases
+  * them, so only new segments are sent while the map stands still and the
+  * whole trail is redrawn, newest first, at most every NEX_TRAIL_REDRAW_MS
+  * after a move. The redraw (about 30 bytes per segment) only uses the budget
+  * left after the dirty widgets and the resync sweep (NEX_Set_Resync_Period())
+  * and may span several frames. A new lap
+  * repaints the map. ASCII mode, dashboard page only.
+  */
+void NEX_Set_Trail(uint8_t enable);
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Result of NEX_Benchmark_Render().
+  * @note   Times run from the commit of the frame to its last acknowledgment
+  *         and include the transmission time (bytes * 10 / baud rate).
+  */
+typedef struct {
+    uint32_t plainMs;        /*!< All-dirty frame, redraw after every command */
+    uint32_t atomicMs;       /*!< Same frame wrapped in ref_stop / ref_star */
+    uint16_t plainBytes;     /*!< Size of the plain frame */
+    uint16_t atomicBytes;    /*!< Size of the wrapped frame */
+    uint16_t commands;       /*!< Widget commands in the frame */
+} NEX_RenderBenchmark;
+
+/**
+  * @brief  Measures the display-side processing time of plain and wrapped frames.
+  * @param  result:  Destination of the measurement.
+  * @param  timeout: Maximum wait for the acknowledgments of one frame, in ms.
+  * @retval HAL_OK, HAL_TIMEOUT if acknowledgments were missing, HAL_ERROR otherwise.
+  * @note   Blocking; ASCII mode only. Call it outside the refresh loop.
+  */
+HAL_StatusTypeDef NEX_Benchmark_Render(NEX_RenderBenchmark *result, uint32_t timeout);
+
+/**
+  * @brief  Result of NEX_Benchmark_Map(), per position update.
+  */
+typedef struct {
+    uint32_t moveUs;         /*!< Average render time of "pMap.x=" / "pMap.y=" */
+    uint32_t cropUs;         /*!< Average render time of "xpic" and the overlay */
+    uint16_t moveBytes;      /*!< Bytes of the last move update */
+    uint16_t cropBytes;      /*!< Bytes of the last crop update */
+    uint16_t updates;        /*!< Position updates per mode */
+} NEX_MapBenchmark;
+
+/**
+  * @brief  Measures the display-side render time of map updates in both modes.
+  * @param  result:  Destination of the measurement.
+  * @param  updates: Position updates sent per mode, along the map diagonal.
+  * @param  timeout: Maximum wait for the acknowledgments of one update, in ms.
+  * @retval HAL_OK, HAL_TIMEOUT if acknowledgments were missing, HAL_ERROR otherwise.
+  * @note   Blocking; ASCII mode only. The HMI needs both pMap and the
+  *         NEX_MAP_PICTURE resource. The map is put back on the next refresh.
+  */
+HAL_StatusTypeDef NEX_Benchmark_Map(NEX_MapBenchmark *result, uint16_t updates, uint32_t timeout);
+
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Switches between ASCII commands and binary frames (protocol reparse mode).
+  * @param  enable: 1 to send binary frames, 0 to return to ASCII commands.
+  * @retval HAL_OK on success, HAL_BUSY during a waveform transfer, HAL_ERROR
+  *         if the mode command could not be sent or a NEX_FORMAT_CROP widget
+  *         is registered.
+  * @note   Blocks until the TX queue has drained. Requires the HMI-side
+  *         unpacker, see NEX_BINARY_HEADER_0. A crop widget does not fit
+  *         one int16, hence the refusal.
+  */
+HAL_StatusTypeDef NEX_Set_Binary_Mode(uint8_t enable);
+
+/**
+  * @brief  Copies the ASCII / binary wire size comparison.
+  * @param  stats: Destination structure.
+  * @note   Both sizes are accounted in either mode, so the comparison can be
+  *         read without switching. Typical frame sizes are bytes / frames.
+  */
+void NEX_Get_Wire_Stats(NEX_WireStats *stats);
+
+/*--------------------- Standard Sources and Encoders ---------------------*/
+
+int32_t NEX_Read_Int(const void *source);      /*!< Source is an int */
+int32_t NEX_Read_State(const void *source);    /*!< Source is a NEX_State */
+int32_t NEX_Read_Gear(const void *source);     /*!< Source is a NEX_Gears */
+int32_t NEX_Read_Indicators(const void *source);  /*!< Source is a NEX_Data, returns the vInd bitmask */
+int32_t NEX_Read_Text(const void *source);     /*!< Source is a char buffer, returns its hash */
+int32_t NEX_Read_Map_Crop(const void *source); /*!< Source is a MapOffset, returns the packed xpic offset */
+
+HAL_StatusTypeDef NEX_Encode_Number(const NEX_WidgetConfig *widget, int32_t value, int32_t *display);  /*!< Sends the value as is */
+HAL_StatusTypeDef NEX_Encode_Scaled(const NEX_WidgetConfig *widget, int32_t value, int32_t *display);  /*!< Maps inMin..inMax to outMin..outMax */
+HAL_StatusTypeDef NEX_Encode_Lookup(const NEX_WidgetConfig *widget, int32_t value, int32_t *display);  /*!< Sends lookup[value] */
+HAL_StatusTypeDef NEX_Encode_Text(const NEX_WidgetConfig *widget, int32_t value, int32_t *display);    /*!< Sends strings[value] or the source text */
+
 #endif // DASHBOARD_CONTROLS
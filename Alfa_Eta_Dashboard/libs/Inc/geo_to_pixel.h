@@ -14,7 +14,20 @@
  *
  * - Designed for use with STM32CubeIDE and STM32 HAL library.
  * - The GPS module is expected to communicate at **9600 Baud Rate** via UART.
- *   Ensure this matches your UART peripheral configuration.
+ *   Ensure this matches your UART peripheral configuration. A u-blox
+ *   receiver can then be moved to 115200 baud and 10 Hz with gps_config.h.
+ * - Reception runs in the background (gps_rx.h, circular DMA + IDLE line);
+ *   Geo_To_Pixel_Run_Pipeline() only processes sentences that have arrived.
+ * - Sentences are parsed as a stream (nmea_parser.h); only sentences with a
+ *   valid checksum are used.
+ * - RMC, GGA, GSA and VTG are read from any talker (GP, GN, GL, ...) and
+ *   merged by epoch (UTC time) into one GPS_Fix. A fix is only used when it
+ *   is valid and its quality passes GPS_MAX_HDOP / GPS_MIN_SATELLITES; a
+ *   larger HDOP widens the jitter deadband, and checkpoints are only
+ *   counted up to GPS_LAP_MAX_HDOP.
+ * - Coordinates are int32_t in 1e-7 degrees (about 1.1 cm) from parsing to
+ *   pixel mapping. Distances use the equirectangular approximation in
+ *   millimetres, within a few centimetres of haversine over a track.
  *
  * Mismatched baud rates can result in corrupted data or no GPS lock at all.
  *
@@ -34,13 +47,16 @@
 
 #include "stm32f4xx_hal.h"
 #include "mapping.h"
+#include "map_trail.h"
+#include "gps_rx.h"
+#include "nmea_parser.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
 
 /*--------------------- Map Dimensions in Pixels ---------------------*/
-#define MAP_X_SIZE 800.00f    /*!< Map width in pixels */
-#define MAP_Y_SIZE 750.00f    /*!< Map height in pixels */
+#define MAP_X_SIZE 800        /*!< Map width in pixels */
+#define MAP_Y_SIZE 750        /*!< Map height in pixels */
 
 /*--------------------- Icon Size and Position Constants ---------------------*/
 #define ICON_WIDTH  67        /*!< Width of the icon in pixels */
@@ -56,13 +72,28 @@
 
 
 
-/*--------------------- Geo Boundaries ---------------------*/
-#define NW_lat 40.791284217f     /*!< Latitude of the top-left (NW) corner of the map */
-#define NW_lon 29.447577362f     /*!< Longitude of the top-left (NW) corner of the map */
-#define SE_lat 40.782318197f      /*!< Latitude of the bottom-right (SE) corner of the map */
-#define SE_lon 29.460412478f      /*!< Longitude of the bottom-right (SE) corner of the map */
+/*--------------------- Geo Boundaries (1e-7 degrees) ---------------------*/
+#define NW_lat 407912842         /*!< Latitude of the top-left (NW) corner of the map */
+#define NW_lon 294475774         /*!< Longitude of the top-left (NW) corner of the map */
+#define SE_lat 407823182         /*!< Latitude of the bottom-right (SE) corner of the map */
+#define SE_lon 294604125         /*!< Longitude of the bottom-right (SE) corner of the map */
 
-#define GPS_BUFFER_SIZE 100      /*!< Size of UART GPS data buffer */
+/*--------------------- Fixed-Point Distance ---------------------*/
+#define GEO_MM_PER_UNIT_Q16 728727  /*!< Millimetres per 1e-7 degree of latitude, Q16 (R = 6371 km) */
+#define GEO_COS_LAT_Q16 49620       /*!< cos() of the map centre latitude, Q16; scales longitude */
+
+/*--------------------- Fix Quality ---------------------*/
+#define GPS_MAX_HDOP 500          /*!< Fixes with a larger HDOP (x100) are not used */
+#define GPS_MIN_SATELLITES 4      /*!< Fixes with fewer satellites are not used */
+#define GPS_LAP_MAX_HDOP 250      /*!< Checkpoints are only counted up to this HDOP (x100) */
+
+/*--------------------- Fix Sentences ---------------------*/
+#define GPS_SENTENCE_RMC 0x01U    /*!< Recommended minimum data: position, speed, course */
+#define GPS_SENTENCE_GGA 0x02U    /*!< Fix data: position, quality, satellites, HDOP, altitude */
+#define GPS_SENTENCE_GSA 0x04U    /*!< DOP and active satellites: fix type, PDOP/HDOP/VDOP */
+#define GPS_SENTENCE_VTG 0x08U    /*!< Course and ground speed */
+
+#define GPS_TIME_UNKNOWN 0xFFFFFFFFU  /*!< GPS_Fix.time before the receiver knows the time */
 
 typedef struct {
     int PixelX;                 /*!< Pixel X coordinate on the map */
@@ -71,14 +102,36 @@ typedef struct {
     int Lap;                    /*!< Current lap or iteration count */
 } MapOffset;
 
+/**
+ * @brief One epoch of the receiver output, merged from all its sentences.
+ *        Quality fields the receiver did not send are 0.
+ */
+typedef struct {
+    uint32_t time;              /*!< UTC time of the epoch in 0.01 s since midnight */
+    int32_t lat;                /*!< Latitude, 1e-7 degrees */
+    int32_t lon;                /*!< Longitude, 1e-7 degrees */
+    int32_t altitude;           /*!< Altitude above mean sea level in cm (GGA) */
+    int32_t speed;              /*!< Ground speed in 0.01 km/h (VTG, else RMC) */
+    int32_t course;             /*!< Course over ground in 0.01 degrees */
+    uint16_t hdop;              /*!< Horizontal dilution of precision x100 */
+    uint16_t pdop;              /*!< Position dilution of precision x100 (GSA) */
+    uint16_t vdop;              /*!< Vertical dilution of precision x100 (GSA) */
+    uint8_t satellites;         /*!< Satellites used in the fix (GGA) */
+    uint8_t quality;            /*!< GGA fix quality: 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float, 6 estimated */
+    uint8_t fixType;            /*!< GSA fix type: 1 none, 2 2D, 3 3D */
+    uint8_t valid;              /*!< 1 if a position was received and no sentence flagged it invalid */
+    uint8_t sentences;          /*!< GPS_SENTENCE_* bits merged into this fix */
+} GPS_Fix;
+
 typedef struct {
-    float raw_lat;              /*!< Raw latitude value from GPS */
-    float raw_lon;              /*!< Raw longitude value from GPS */
-    float last_lat;             /*!< Last filtered latitude */
-    float last_lon;             /*!< Last filtered longitude */
-    float filtered_lat;         /*!< Filtered latitude for smoothing */
-    float filtered_lon;         /*!< Filtered longitude for smoothing */
-    float speed;                /*!< Speed in km/h */
+    int32_t raw_lat;            /*!< Raw latitude value from GPS, 1e-7 degrees */
+    int32_t raw_lon;            /*!< Raw longitude value from GPS, 1e-7 degrees */
+    int32_t last_lat;           /*!< Last filtered latitude */
+    int32_t last_lon;           /*!< Last filtered longitude */
+    int32_t filtered_lat;       /*!< Filtered latitude for smoothing */
+    int32_t filtered_lon;       /*!< Filtered longitude for smoothing */
+    int32_t speed;              /*!< Speed in 0.01 km/h */
+    GPS_Fix fix;                /*!< Most recent complete epoch, used or not */
 } GPS_Data;
 
 
@@ -87,8 +140,8 @@ typedef struct {
  */
 typedef struct {
     uint8_t status;             /*!< Checkpoint status: 0 = not reached, 1 = reached */
-    float lat;                  /*!< Latitude of the checkpoint */
-    float lon;                  /*!< Longitude of the checkpoint */
+    int32_t lat;                /*!< Latitude of the checkpoint, 1e-7 degrees */
+    int32_t lon;                /*!< Longitude of the checkpoint, 1e-7 degrees */
 } GPS_Checkpoint;
 
 
@@ -113,12 +166,41 @@ HAL_StatusTypeDef Geo_To_Pixel_Init(UART_HandleTypeDef *uart, MapOffset *mapData
 HAL_StatusTypeDef Geo_To_Pixel_Bind(UART_HandleTypeDef *uart, MapOffset *mapData);
 
 /**
-  * @brief  Runs the complete GPS-to-pixel update pipeline.
+  * @brief  Processes the GPS sentences received since the last call.
   * @retval HAL_StatusTypeDef
-  *         - HAL_OK: Pipeline executed successfully.
-  *         - HAL_ERROR: GPS data read failed.
+  *         - HAL_OK: A new position was processed.
+  *         - HAL_BUSY: No epoch was completed since the last call.
+  *         - HAL_ERROR: Epochs were completed, but none had a usable fix.
+  * @note   Never blocks; call it from the main loop.
   */
 HAL_StatusTypeDef Geo_To_Pixel_Run_Pipeline(void);
 
+/**
+  * @brief  Returns the most recent complete epoch with its quality fields.
+  * @retval Pointer to the fix; time is GPS_TIME_UNKNOWN before the first epoch.
+  */
+const GPS_Fix *Geo_To_Pixel_Get_Fix(void);
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Result of Geo_To_Pixel_Benchmark(), per position.
+  */
+typedef struct {
+    uint32_t floatCycles;    /*!< atof() parsing, haversine distance and Map_Float() */
+    uint32_t fixedCycles;    /*!< Integer parsing, distance and mapping */
+    uint32_t floatErrorMm;   /*!< Largest position error of the float path, in mm */
+} GeoPixelBenchmark;
+
+/**
+  * @brief  Runs sample positions through the former float path and the
+  *         fixed-point path, comparing cycles and precision.
+  * @param  iterations: Passes over the samples (averaged).
+  * @param  result:     Destination for the measurement.
+  */
+void Geo_To_Pixel_Benchmark(uint32_t iterations, GeoPixelBenchmark *result);
+
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
 
 #endif // GEO_TO_PIXEL
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file           : gps_config.h
+ * @brief          : Boot-time configuration of a u-blox GNSS receiver
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Out of the box the receiver sends every NMEA sentence once per second at
+ * 9600 baud. GPS_Config_Apply() sends UBX configuration messages so that it
+ * sends only what the dashboard reads, faster:
+ *
+ *  - UBX-CFG-MSG:  GLL and GSV off; RMC, VTG, GGA and GSA every epoch.
+ *  - UBX-CFG-PRT:  UART1 moved to GPS_CONFIG_BAUD_RATE, UBX + NMEA.
+ *  - UBX-CFG-RATE: navigation period GPS_CONFIG_PERIOD_MS (10 Hz).
+ *
+ * Every step waits (blocking) for its UBX-ACK-ACK. The receiver is first
+ * looked for at the current UART rate and then at the target rate, where it
+ * still is after a reset of the MCU alone. If it does not answer at the new
+ * rate, the link goes back to the original one and the navigation rate is
+ * left at 1 Hz, which is all 9600 baud can carry. If it never answers (no
+ * receiver, or not a u-blox), nothing is changed and the default NMEA
+ * output keeps working.
+ *
+ * The settings are not saved in the receiver; it returns to its defaults
+ * after a power cycle and is configured again on the next boot.
+ *
+ * IMPORTANT:
+ * - Call after Geo_To_Pixel_Init(): the ACKs are read through gps_rx.h.
+ * - Blocks for up to a few times the timeout; call it once at boot only.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef GPS_CONFIG
+#define GPS_CONFIG
+
+#include "stm32f4xx_hal.h"
+
+#define GPS_CONFIG_BAUD_RATE 115200U     /*!< Link rate requested from the receiver */
+#define GPS_CONFIG_PERIOD_MS 100U        /*!< Navigation period (10 Hz) */
+#define GPS_CONFIG_ACK_TIMEOUT_MS 250U   /*!< Wait for each acknowledgment, used in main.c */
+#define GPS_CONFIG_SWITCH_DELAY_MS 50U   /*!< Time given to the receiver to apply CFG-PRT */
+
+/**
+ * @brief Outcome of GPS_Config_Apply().
+ */
+typedef struct {
+    uint32_t baudRate;       /*!< Link rate in use afterwards */
+    uint16_t periodMs;       /*!< Navigation period in use (1000 if unchanged) */
+    uint8_t acknowledged;    /*!< Commands answered with ACK-ACK */
+    uint8_t rejected;        /*!< Commands answered with ACK-NAK */
+    uint8_t unanswered;      /*!< Commands without an answer in time */
+} GPS_Config_Result;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Configures the receiver and moves the UART to the new rate.
+  * @param  uart:     UART handle of the GPS module (already receiving).
+  * @param  baudRate: Link rate to switch to, e.g. GPS_CONFIG_BAUD_RATE.
+  * @param  periodMs: Navigation period, e.g. GPS_CONFIG_PERIOD_MS.
+  * @param  timeout:  Wait for each acknowledgment in ms.
+  * @retval HAL_OK:      Every step was acknowledged.
+  *         HAL_ERROR:   The receiver answered, but a step failed; the link
+  *                      is at a rate both sides use.
+  *         HAL_TIMEOUT: No receiver answered; the UART is back at its
+  *                      original rate.
+  */
+HAL_StatusTypeDef GPS_Config_Apply(UART_HandleTypeDef *uart, uint32_t baudRate, uint16_t periodMs, uint32_t timeout);
+
+/**
+  * @brief  Copies the outcome of the last GPS_Config_Apply().
+  * @param  result: Destination structure.
+  */
+void GPS_Config_Get_Result(GPS_Config_Result *result);
+
+#endif // GPS_CONFIG
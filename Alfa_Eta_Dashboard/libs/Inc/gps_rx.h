@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ * @file           : gps_rx.h
+ * @brief          : Background reception of NMEA sentences from the GPS module
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * The UART RX DMA stream runs in circular mode into GPS_RX_BUFFER_SIZE bytes,
+ * so the module is received continuously while the main loop does other
+ * work. The IDLE-line, half-transfer and transfer-complete interrupts report
+ * the DMA write position; the interrupt only publishes how many bytes
+ * arrived. GPS_Rx_Read() is polled from the main loop and returns the
+ * waiting bytes in place in the DMA buffer, to be fed to the NMEA parser
+ * (nmea_parser.h). It never blocks.
+ *
+ * After gps_config.h (115200 baud, 10 Hz, RMC/VTG/GGA/GSA) about 4 KB arrive
+ * per second, so the buffer holds half a second of data; the main loop must
+ * poll at least that often. At the 9600 baud default it holds two seconds.
+ * If the main loop falls further behind, the unread bytes are dropped and
+ * counted as an overrun.
+ *
+ * IMPORTANT:
+ * - The UART handle must have an RX DMA stream in circular mode linked
+ *   (hdmarx) and its global interrupt enabled.
+ * - HAL_UARTEx_RxEventCallback() must forward to GPS_Rx_Event_Callback() and
+ *   HAL_UART_ErrorCallback() to GPS_Rx_Error_Callback().
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef GPS_RX
+#define GPS_RX
+
+#include "stm32f4xx_hal.h"
+
+#define GPS_RX_BUFFER_SIZE 2048U    /*!< Circular RX DMA buffer in bytes (power of two) */
+
+/**
+ * @brief Receiver counters.
+ */
+typedef struct {
+    uint32_t bytes;          /*!< Bytes received */
+    uint32_t overruns;       /*!< Times unread bytes were overwritten by the DMA */
+    uint32_t restarts;       /*!< Receptions restarted after a UART error */
+} GPS_Rx_Stats;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Binds the UART and starts the circular reception.
+  * @param  uart: UART handle of the GPS module.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef GPS_Rx_Init(UART_HandleTypeDef *uart);
+
+/**
+  * @brief  Restarts the circular reception and drops unread bytes.
+  */
+HAL_StatusTypeDef GPS_Rx_Start(void);
+
+/**
+  * @brief  Stops the reception.
+  */
+void GPS_Rx_Stop(void);
+
+/**
+  * @brief  Returns the next run of unread bytes, in place in the DMA buffer.
+  * @param  data: Receives a pointer to the first byte.
+  * @retval Number of bytes at data, 0 if nothing is waiting. Call again
+  *         until it returns 0; wrapped data comes in two runs.
+  * @note   Main loop only; never blocks. The bytes stay valid until the DMA
+  *         laps the buffer, so feed them to the parser right away.
+  */
+uint16_t GPS_Rx_Read(const uint8_t **data);
+
+/**
+  * @brief  Copies the receiver counters.
+  * @param  stats: Destination structure.
+  */
+void GPS_Rx_Get_Stats(GPS_Rx_Stats *stats);
+
+/**
+  * @brief  Call from HAL_UARTEx_RxEventCallback().
+  * @param  huart: UART handle reporting the event.
+  * @param  size:  DMA write position in the buffer.
+  */
+void GPS_Rx_Event_Callback(UART_HandleTypeDef *huart, uint16_t size);
+
+/**
+  * @brief  Call from HAL_UART_ErrorCallback(); restarts an aborted reception.
+  * @param  huart: UART handle reporting the error.
+  */
+void GPS_Rx_Error_Callback(UART_HandleTypeDef *huart);
+
+#endif // GPS_RX
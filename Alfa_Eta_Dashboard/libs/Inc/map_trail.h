@@ -0,0 +1,117 @@
+/**
+ ******************************************************************************
+ * @file           : map_trail.h
+ * @brief          : Decimated polyline of the path driven in the current lap
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Positions are map pixels (the coordinates of the map picture, not of the
+ * screen). Every new position is simplified online before it is stored:
+ *
+ *  - A position closer than MAP_TRAIL_MIN_DISTANCE to the last vertex is
+ *    jitter and ignored.
+ *  - If the path keeps its direction within MAP_TRAIL_ANGLE_TOLERANCE, the
+ *    last vertex is moved to the new position instead of adding a vertex.
+ *  - Otherwise the new position becomes a new vertex.
+ *
+ * The test is done on integers (cross and dot products against the squared
+ * sine of the tolerance), so one point costs a fixed, small number of cycles
+ * and the vertex count depends on the shape of the path, not on the GPS rate.
+ * The polyline holds at most MAP_TRAIL_MAX_POINTS vertices; the oldest ones
+ * are dropped first. Positions are clamped to +-MAP_TRAIL_LIMIT pixels, which
+ * keeps the products of the test within int64_t and the vertices in int16_t.
+ *
+ * Build with DASHBOARD_ENABLE_BENCHMARK for Map_Trail_Benchmark(), which
+ * reports the decimation cost per point in CPU cycles.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef MAP_TRAIL
+#define MAP_TRAIL
+
+#include "stm32f4xx_hal.h"
+
+#define MAP_TRAIL_MAX_POINTS 32U          /*!< Vertices kept (31 segments) */
+#define MAP_TRAIL_MIN_DISTANCE 6          /*!< Movements below this many pixels are ignored */
+#define MAP_TRAIL_ANGLE_TOLERANCE 10      /*!< Direction change in degrees that starts a new vertex */
+#define MAP_TRAIL_LIMIT 2048              /*!< Positions are clamped to +-this many pixels */
+
+/**
+  * @brief  sin^2(MAP_TRAIL_ANGLE_TOLERANCE) in Q16, for the integer collinearity test.
+  */
+#define MAP_TRAIL_SIN2_Q16 1976           /* sin(10 deg)^2 * 65536 */
+
+/**
+  * @brief  One vertex of the trail, in map pixels.
+  */
+typedef struct {
+    int16_t x;
+    int16_t y;
+} Map_Trail_Point;
+
+/**
+  * @brief  Decimation counters.
+  */
+typedef struct {
+    uint32_t points;         /*!< Positions passed to Map_Trail_Add() */
+    uint32_t ignored;        /*!< Positions within MAP_TRAIL_MIN_DISTANCE */
+    uint32_t merged;         /*!< Positions that moved the last vertex */
+    uint32_t vertices;       /*!< Positions that became a new vertex */
+} Map_Trail_Stats;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Clears the trail, e.g. at the start of a lap.
+  */
+void Map_Trail_Reset(void);
+
+/**
+  * @brief  Adds a position to the trail.
+  * @param  x: Map pixel X, clamped to +-MAP_TRAIL_LIMIT.
+  * @param  y: Map pixel Y, clamped to +-MAP_TRAIL_LIMIT.
+  * @retval 1 if the polyline changed, 0 if the position was ignored.
+  */
+uint8_t Map_Trail_Add(int x, int y);
+
+/**
+  * @brief  Returns the number of vertices.
+  */
+uint8_t Map_Trail_Get_Count(void);
+
+/**
+  * @brief  Returns vertex index, 0 being the oldest.
+  * @param  index: Vertex index, below Map_Trail_Get_Count().
+  */
+Map_Trail_Point Map_Trail_Get_Point(uint8_t index);
+
+/**
+  * @brief  Copies the decimation counters.
+  * @param  stats: Destination structure.
+  */
+void Map_Trail_Get_Stats(Map_Trail_Stats *stats);
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Measures Map_Trail_Add() on a synthetic lap with GPS-like jitter.
+  * @param  points: Number of positions fed.
+  * @retval Average CPU cycles per position.
+  * @note   Resets the trail before and after the measurement.
+  */
+uint32_t Map_Trail_Benchmark(uint32_t points);
+
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+#endif // MAP_TRAIL
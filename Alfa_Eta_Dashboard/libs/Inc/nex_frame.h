@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ * @file           : nex_frame.h
+ * @brief          : Single-burst frame assembly for Nextion commands
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * A frame collects every command produced by one NEX_Refresh() call, each one
+ * followed by its 0xFF 0xFF 0xFF terminator, in one contiguous buffer. The
+ * whole frame is then handed to the TX queue (nex_link.h) in a single write,
+ * which the DMA sends in a single transfer.
+ *
+ * Usage:
+ *   NEX_Frame_Begin();
+ *   NEX_Frame_Append("nSd.val=42");
+ *   ...
+ *   NEX_Frame_Commit();
+ *
+ * NEX_Frame_Begin() caps the frame at the space the TX queue can take, so an
+ * append that succeeds is guaranteed to be sent by NEX_Frame_Commit().
+ *
+ * Numeric commands are encoded without printf: NEX_Frame_Append_Int() copies a
+ * constant prefix (e.g. "nSd.val=") and writes the digits with a table-driven
+ * integer-to-ASCII routine. The library does not depend on stdio.
+ *
+ * Text commands (NEX_Frame_Append_Text()) are quoted and escaped: '"' and
+ * '\' get a backslash, '\n' becomes the Nextion line break "\r", and 0xFF
+ * bytes, which would end the command early, are dropped.
+ *
+ * Build with DASHBOARD_ENABLE_BENCHMARK defined to get
+ * NEX_Frame_Benchmark_Int(), which compares the encoder against the former
+ * snprintf() path in CPU cycles (pulls snprintf into that build only).
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef NEX_FRAME
+#define NEX_FRAME
+
+#include "stm32f4xx_hal.h"
+#include "nex_link.h"
+
+#define NEX_FRAME_BUFFER_SIZE 384U  /*!< Maximum size of one refresh frame in bytes */
+#define NEX_TEXT_MAX_LENGTH 64U     /*!< Characters of a text value sent at most (before escaping) */
+#define NEX_COMMAND_END_SIZE 3U     /*!< 0xFF 0xFF 0xFF terminator after every command */
+
+/**
+  * @brief  Builds a NEX_Prefix initializer from a string literal.
+  *         The length is computed at compile time.
+  */
+#define NEX_PREFIX(str) { (str), (uint8_t)(sizeof(str) - 1U) }
+
+/**
+  * @brief  Constant command prefix of a numeric widget, e.g. "nSd.val=".
+  */
+typedef struct {
+    const char *text;        /*!< Prefix characters, not null-terminated on the wire */
+    uint8_t length;          /*!< Number of characters in text */
+} NEX_Prefix;
+
+/**
+  * @brief  Size information about committed frames.
+  */
+typedef struct {
+    uint16_t size;           /*!< Bytes in the last committed frame, terminators included */
+    uint16_t commands;       /*!< Commands in the last committed frame */
+    uint16_t peakSize;       /*!< Largest frame committed since start-up */
+    uint32_t frames;         /*!< Number of non-empty frames committed */
+} NEX_FrameInfo;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Starts a new, empty frame.
+  * @note   The frame capacity is the smaller of NEX_FRAME_BUFFER_SIZE and
+  *         the block the TX queue currently accepts.
+  */
+void NEX_Frame_Begin(void);
+
+/**
+  * @brief  Starts a new, empty frame limited to a byte budget.
+  * @param  budget: Maximum frame size in bytes, terminators included.
+  * @note   The capacity is additionally capped like NEX_Frame_Begin().
+  */
+void NEX_Frame_Begin_Budget(uint16_t budget);
+
+/**
+  * @brief  Opens the frame with a command and reserves room for its closing counterpart.
+  * @param  open:  Command sent first, e.g. "ref_stop".
+  * @param  close: Command NEX_Frame_Commit() appends last, e.g. "ref_star".
+  * @retval HAL_OK if wrapped, HAL_ERROR if the frame is not empty or too small.
+  * @note   A frame holding nothing but the opening command is dropped on
+  *         commit, so an idle refresh sends no bytes.
+  */
+HAL_StatusTypeDef NEX_Frame_Wrap(const char *open, const char *close);
+
+/**
+  * @brief  Appends a command and its 3-byte terminator to the open frame.
+  * @param  cmd: Null-terminated command string (e.g. "pHb.aph=127").
+  * @retval HAL_OK if appended, HAL_ERROR if the frame has no room left.
+  *         The frame is left unchanged on error.
+  */
+HAL_StatusTypeDef NEX_Frame_Append(const char *cmd);
+
+/**
+  * @brief  Appends "<prefix><value>" and its 3-byte terminator to the open frame.
+  * @param  prefix: Constant command prefix, e.g. NEX_PREFIX("pMap.y=").
+  * @param  value:  Signed value written in decimal.
+  * @retval HAL_OK if appended, HAL_ERROR if the frame has no room left.
+  *         The frame is left unchanged on error.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Int(const NEX_Prefix *prefix, int32_t value);
+
+/**
+  * @brief  Appends "<prefix><v0>,<v1>,..." and its 3-byte terminator to the open frame.
+  * @param  prefix: Constant command prefix, e.g. NEX_PREFIX("addt ").
+  * @param  values: Arguments written in decimal, separated by commas.
+  * @param  count:  Number of arguments (at least 1).
+  * @retval HAL_OK if appended, HAL_ERROR if the frame has no room left.
+  *         The frame is left unchanged on error.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Ints(const NEX_Prefix *prefix, const int32_t *values, uint8_t count);
+
+/**
+  * @brief  Appends <prefix>"<escaped text>" and its 3-byte terminator to the open frame.
+  * @param  prefix: Constant command prefix, e.g. NEX_PREFIX("tFlt.txt=").
+  * @param  text:   Null-terminated text, cut at NEX_TEXT_MAX_LENGTH characters.
+  * @retval HAL_OK if appended, HAL_ERROR if the frame has no room left.
+  *         The frame is left unchanged on error.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Text(const NEX_Prefix *prefix, const char *text);
+
+/**
+  * @brief  Returns the wire size of a text command, terminator included.
+  * @param  prefix: Constant command prefix.
+  * @param  text:   Text that would be written.
+  */
+uint16_t NEX_Frame_Text_Size(const NEX_Prefix *prefix, const char *text);
+
+/**
+  * @brief  Appends raw bytes to the open frame, without a terminator.
+  * @param  data: Bytes to append (e.g. a binary frame in protocol reparse mode).
+  * @param  len:  Number of bytes.
+  * @retval HAL_OK if appended, HAL_ERROR if the frame has no room left.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Bytes(const uint8_t *data, uint16_t len);
+
+/**
+  * @brief  Returns the wire size of "<prefix><value>" plus its terminator.
+  * @param  prefix: Constant command prefix.
+  * @param  value:  Value that would be written.
+  */
+uint16_t NEX_Frame_Int_Size(const NEX_Prefix *prefix, int32_t value);
+
+/**
+  * @brief  Returns the wire size of "<prefix><v0>,<v1>,..." plus its terminator.
+  * @param  prefix: Constant command prefix.
+  * @param  values: Arguments that would be written.
+  * @param  count:  Number of arguments.
+  */
+uint16_t NEX_Frame_Ints_Size(const NEX_Prefix *prefix, const int32_t *values, uint8_t count);
+
+/**
+  * @brief  Hands the open frame to the TX queue in one write.
+  * @retval HAL_OK if queued (or the frame is empty), HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NEX_Frame_Commit(void);
+
+/**
+  * @brief  Returns the number of bytes in the open frame.
+  */
+uint16_t NEX_Frame_Get_Size(void);
+
+/**
+  * @brief  Returns the bytes the open frame can still take (budget and
+  *         reserved closing command considered).
+  */
+uint16_t NEX_Frame_Get_Free(void);
+
+/**
+  * @brief  Copies the size information of committed frames.
+  * @param  info: Destination structure.
+  */
+void NEX_Frame_Get_Info(NEX_FrameInfo *info);
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Result of NEX_Frame_Benchmark_Int(), average CPU cycles per command.
+  */
+typedef struct {
+    uint32_t snprintfCycles; /*!< snprintf("nSd.val=%d") followed by NEX_Frame_Append() */
+    uint32_t encoderCycles;  /*!< NEX_Frame_Append_Int() with a constant prefix */
+} NEX_EncoderBenchmark;
+
+/**
+  * @brief  Measures both numeric encoding paths with the DWT cycle counter.
+  * @param  value:      Value to encode.
+  * @param  iterations: Number of encodes per path (averaged).
+  * @param  result:     Destination for the average cycle counts.
+  * @note   Opens and discards frames; do not call between Begin and Commit.
+  */
+void NEX_Frame_Benchmark_Int(int32_t value, uint32_t iterations, NEX_EncoderBenchmark *result);
+
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+#endif // NEX_FRAME
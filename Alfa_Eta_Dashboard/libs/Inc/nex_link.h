@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ * @file           : nex_link.h
+ * @brief          : Non-blocking DMA transmit queue for the Nextion UART link
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * This module owns the byte stream going to the Nextion display. Callers
+ * enqueue complete commands into a ring buffer and return immediately; the
+ * queue is drained in the background by the UART TX DMA stream and refilled
+ * from the transfer-complete interrupt.
+ *
+ * IMPORTANT:
+ * - The UART handle must have a TX DMA stream linked (hdmatx) and its
+ *   global interrupt enabled, otherwise the queue will never drain.
+ * - HAL_UART_TxCpltCallback() and HAL_UART_ErrorCallback() must forward to
+ *   NEX_Link_TxCplt_Callback() / NEX_Link_Error_Callback().
+ *
+ * The queue can be paused for a while (NEX_Link_Pause()) when the display
+ * reports a serial buffer overflow; queued data is kept and sent afterwards.
+ *
+ * The hardware access is isolated in NEX_Link_Start_Transmit(), a weak
+ * function. A host build can override it with a simulated UART/DMA that
+ * consumes the chunk and calls NEX_Link_TxCplt_Callback() itself, as
+ * tests/nex_link_sim.c does.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef NEX_LINK
+#define NEX_LINK
+
+#include "stm32f4xx_hal.h"
+
+#define NEX_LINK_TX_QUEUE_SIZE 512U  /*!< Capacity of the TX ring queue in bytes */
+
+/**
+  * @brief  Runtime counters of the TX queue.
+  */
+typedef struct {
+    uint16_t depth;          /*!< Bytes waiting in the queue, including the DMA chunk in flight */
+    uint16_t peakDepth;      /*!< Highest depth observed since NEX_Link_Init() */
+    uint32_t overflows;      /*!< Writes rejected because the queue had no room */
+    uint32_t bytesQueued;    /*!< Total bytes accepted into the queue */
+    uint32_t transfers;      /*!< DMA transfers started */
+    uint32_t errors;         /*!< Transfers aborted by a UART/DMA error */
+    uint32_t pauses;         /*!< Calls to NEX_Link_Pause() */
+} NEX_Link_Stats;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Binds the UART handle and empties the TX queue.
+  * @param  uart: Pointer to the UART handle used for Nextion communication.
+  * @retval HAL_OK on success, HAL_ERROR if uart is NULL.
+  */
+HAL_StatusTypeDef NEX_Link_Init(UART_HandleTypeDef *uart);
+
+/**
+  * @brief  Appends bytes to the TX queue and starts the DMA if it is idle.
+  * @param  data: Bytes to send.
+  * @param  len:  Number of bytes.
+  * @retval HAL_OK if all bytes were queued.
+  * @retval HAL_ERROR if the queue had no room; nothing is queued in that case.
+  * @note   Writes are all-or-nothing so a command is never split on overflow,
+  *         and each block is stored contiguously so it leaves in one DMA
+  *         transfer once it reaches the head of the queue.
+  */
+HAL_StatusTypeDef NEX_Link_Write(const uint8_t *data, uint16_t len);
+
+/**
+  * @brief  Returns the largest block NEX_Link_Write() currently accepts.
+  * @note   Blocks are stored contiguously, so this can be less than the total
+  *         free space. It never shrinks until the next write.
+  */
+uint16_t NEX_Link_Get_Free(void);
+
+/**
+  * @brief  Returns the number of bytes waiting in the queue, including the
+  *         chunk the DMA is sending.
+  */
+uint16_t NEX_Link_Get_Depth(void);
+
+/**
+  * @brief  Blocks until the TX queue is fully drained.
+  * @param  timeout: Maximum time to wait in milliseconds.
+  * @retval HAL_OK if the queue drained, HAL_TIMEOUT otherwise.
+  */
+HAL_StatusTypeDef NEX_Link_Flush(uint32_t timeout);
+
+/**
+  * @brief  Holds back further DMA transfers for a while.
+  * @param  pauseMs: Pause length in milliseconds, counted from now.
+  * @note   Safe to call from interrupt context. A transfer already running is
+  *         completed; queued bytes stay queued and NEX_Link_Service() or the
+  *         next write resumes draining once the pause is over.
+  */
+void NEX_Link_Pause(uint32_t pauseMs);
+
+/**
+  * @brief  Restarts draining after a pause. Call periodically (NEX_Refresh() does).
+  */
+void NEX_Link_Service(void);
+
+/**
+  * @brief  Copies the current queue counters.
+  * @param  stats: Destination structure.
+  */
+void NEX_Link_Get_Stats(NEX_Link_Stats *stats);
+
+/**
+  * @brief  Must be called from HAL_UART_TxCpltCallback().
+  * @param  huart: UART handle that completed its transfer.
+  */
+void NEX_Link_TxCplt_Callback(UART_HandleTypeDef *huart);
+
+/**
+  * @brief  Must be called from HAL_UART_ErrorCallback().
+  * @param  huart: UART handle that reported the error.
+  */
+void NEX_Link_Error_Callback(UART_HandleTypeDef *huart);
+
+/**
+  * @brief  Starts one background transfer of a contiguous queue chunk.
+  * @param  uart: UART handle bound by NEX_Link_Init().
+  * @param  data: Start of the chunk inside the queue.
+  * @param  len:  Chunk length in bytes.
+  * @retval HAL status of the transfer request.
+  * @note   Weak: the default uses HAL_UART_Transmit_DMA(). Override it to
+  *         run the queue against a simulated UART/DMA on a host build.
+  */
+HAL_StatusTypeDef NEX_Link_Start_Transmit(UART_HandleTypeDef *uart, const uint8_t *data, uint16_t len);
+
+#endif // NEX_LINK
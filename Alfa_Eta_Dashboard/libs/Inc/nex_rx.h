@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ * @file           : nex_rx.h
+ * @brief          : Background receiver for Nextion responses and events
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * The UART RX DMA stream runs in circular mode into a small ring buffer and
+ * the IDLE-line interrupt reports how far it got. Incoming bytes are split
+ * into Nextion responses (code byte, payload, 0xFF 0xFF 0xFF) and every
+ * response is dispatched to the handler registered for its code. Handlers
+ * get a view into the ring buffer, so nothing is copied.
+ *
+ * IMPORTANT:
+ * - The UART handle must have an RX DMA stream in circular mode linked
+ *   (hdmarx) and its global interrupt enabled.
+ * - HAL_UARTEx_RxEventCallback() must forward to NEX_Rx_Event_Callback() and
+ *   HAL_UART_ErrorCallback() to NEX_Rx_Error_Callback().
+ * - Handlers run in interrupt context. Keep them short and only set flags
+ *   for work that touches main-loop state.
+ *
+ * A "Serial Buffer Overflow" response (0x24) pauses the TX queue for
+ * NEX_RX_OVERFLOW_PAUSE_MS before its handler is called, so the display can
+ * work through its input buffer.
+ *
+ * The plain "OK" the display prints while waiting for the handshake carries
+ * no terminator; it is recognised separately, see NEX_Rx_Take_Ok().
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef NEX_RX
+#define NEX_RX
+
+#include "stm32f4xx_hal.h"
+
+#define NEX_RX_BUFFER_SIZE 128U         /*!< Size of the circular RX DMA buffer in bytes */
+#define NEX_RX_MAX_FRAME 64U            /*!< Longest accepted response, terminator excluded */
+#define NEX_RX_MAX_HANDLERS 16U         /*!< Capacity of the handler table */
+#define NEX_RX_OVERFLOW_PAUSE_MS 50U    /*!< TX pause after a serial buffer overflow */
+
+/**
+ * @brief Nextion return codes handled by the library.
+ */
+typedef enum {
+    NEX_RX_INVALID_INSTRUCTION = 0x00U,  /*!< Invalid instruction (also start-up 00 00 00) */
+    NEX_RX_SUCCESS             = 0x01U,  /*!< Instruction successful (bkcmd 1 or 3) */
+    NEX_RX_INVALID_COMPONENT   = 0x02U,  /*!< Invalid component ID */
+    NEX_RX_INVALID_VARIABLE    = 0x1AU,  /*!< Invalid variable name or attribute */
+    NEX_RX_BUFFER_OVERFLOW     = 0x24U,  /*!< Serial buffer overflow, commands were lost */
+    NEX_RX_TOUCH_EVENT         = 0x65U,  /*!< Touch event: page, component, event */
+    NEX_RX_CURRENT_PAGE        = 0x66U,  /*!< Current page number */
+    NEX_RX_STRING_DATA         = 0x70U,  /*!< String data, variable length */
+    NEX_RX_NUMERIC_DATA        = 0x71U,  /*!< 32-bit little-endian numeric data */
+    NEX_RX_READY               = 0x88U,  /*!< Display finished booting */
+    NEX_RX_TRANSPARENT_END     = 0xFDU,  /*!< Transparent data transfer finished */
+    NEX_RX_TRANSPARENT_READY   = 0xFEU   /*!< Ready for transparent data */
+} NEX_RxCode;
+
+/**
+  * @brief  Zero-copy view of a response payload inside the ring buffer.
+  *         The payload is split in two parts when it wraps around the end.
+  */
+typedef struct {
+    const uint8_t *first;    /*!< Start of the payload */
+    uint16_t firstLength;    /*!< Bytes available at first */
+    const uint8_t *second;   /*!< Continuation at the ring start, NULL if not wrapped */
+    uint16_t secondLength;   /*!< Bytes available at second */
+} NEX_RxView;
+
+/**
+  * @brief  Response handler.
+  * @param  code:    Return code (first byte of the response).
+  * @param  payload: Bytes between the code and the terminator.
+  * @note   Runs in interrupt context; the view is only valid during the call.
+  */
+typedef void (*NEX_Rx_Handler)(uint8_t code, const NEX_RxView *payload);
+
+/**
+  * @brief  Receiver counters.
+  */
+typedef struct {
+    uint32_t bytes;          /*!< Bytes received */
+    uint32_t frames;         /*!< Complete responses */
+    uint32_t errors;         /*!< Responses with an error code (0x00..0x23) */
+    uint32_t overflows;      /*!< Serial buffer overflow responses (0x24) */
+    uint32_t dropped;        /*!< Bytes discarded while resynchronising */
+    uint32_t restarts;       /*!< Receptions restarted after a UART error */
+    uint32_t lineErrors;     /*!< Framing and noise errors (wrong baud rate, line noise) */
+    uint8_t lastError;       /*!< Most recent error code */
+} NEX_Rx_Stats;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Binds the UART, clears the handler table and starts receiving.
+  * @param  uart: Pointer to the UART handle used for Nextion communication.
+  * @retval HAL_OK on success, HAL_ERROR if uart is NULL or reception failed to start.
+  */
+HAL_StatusTypeDef NEX_Rx_Init(UART_HandleTypeDef *uart);
+
+/**
+  * @brief  (Re)starts the circular DMA reception, e.g. after a baud rate change.
+  * @retval HAL status of HAL_UARTEx_ReceiveToIdle_DMA().
+  */
+HAL_StatusTypeDef NEX_Rx_Start(void);
+
+/**
+  * @brief  Stops the reception before the UART is reconfigured.
+  */
+void NEX_Rx_Stop(void);
+
+/**
+  * @brief  Registers the handler of a return code, replacing an existing one.
+  * @param  code:    Return code.
+  * @param  handler: Handler function, NULL removes the entry.
+  * @retval HAL_OK on success, HAL_ERROR if the table is full.
+  */
+HAL_StatusTypeDef NEX_Rx_Register_Handler(uint8_t code, NEX_Rx_Handler handler);
+
+/**
+  * @brief  Reports whether an "OK" handshake message arrived since the last call.
+  * @retval 1 if "OK" was received, 0 otherwise.
+  */
+uint8_t NEX_Rx_Take_Ok(void);
+
+/**
+  * @brief  Returns payload byte i of a view.
+  * @param  view:  Payload view passed to a handler.
+  * @param  index: Byte index, must be below firstLength + secondLength.
+  */
+uint8_t NEX_Rx_View_Byte(const NEX_RxView *view, uint16_t index);
+
+/**
+  * @brief  Copies the receiver counters.
+  * @param  stats: Destination structure.
+  */
+void NEX_Rx_Get_Stats(NEX_Rx_Stats *stats);
+
+/**
+  * @brief  Must be called from HAL_UARTEx_RxEventCallback().
+  * @param  huart: UART handle that reported the event.
+  * @param  size:  Write position of the DMA in the ring buffer.
+  */
+void NEX_Rx_Event_Callback(UART_HandleTypeDef *huart, uint16_t size);
+
+/**
+  * @brief  Must be called from HAL_UART_ErrorCallback().
+  * @param  huart: UART handle that reported the error.
+  */
+void NEX_Rx_Error_Callback(UART_HandleTypeDef *huart);
+
+#endif // NEX_RX
@@ -0,0 +1,166 @@
+/**
+ ******************************************************************************
+ * @file           : nmea_parser.h
+ * @brief          : Streaming NMEA 0183 parser with checksum validation
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * The parser is a byte-at-a-time state machine. It can be fed any split of
+ * the input stream (single bytes, DMA chunks, wrapped buffers), and keeps
+ * the partial sentence between calls:
+ *
+ *   '$' -> body -> '*' -> two hex digits -> CR/LF
+ *
+ * While the body arrives, the XOR checksum is accumulated and every ','
+ * is replaced by '\0' with the start of the next field recorded. A finished
+ * sentence is therefore a set of ready C strings in the parser's line
+ * buffer; nothing is tokenized or copied a second time.
+ *
+ * Only sentences whose checksum matches are passed on, to the handler
+ * registered for their address (e.g. "GNRMC"). A '-' in a registered address
+ * matches any character, so "--RMC" takes RMC from any talker (GP, GN, GL,
+ * GA, ...); the first matching entry wins. A '$' always starts a new
+ * sentence, so a cut-off sentence is dropped and the parser resynchronises
+ * on the next one. Sentences without a checksum are rejected.
+ *
+ * Handlers run inside NMEA_Parser_Feed(); the sentence is only valid during
+ * the call. NMEA_Parser_To_Fixed() and NMEA_Parser_To_Coordinate() convert
+ * fields to integers without going through float.
+ *
+ * Build with DASHBOARD_ENABLE_BENCHMARK for NMEA_Parser_Benchmark(), which
+ * reports the parsing cost in CPU cycles per byte and sentences per second.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef NMEA_PARSER
+#define NMEA_PARSER
+
+#include "stm32f4xx_hal.h"
+
+#define NMEA_MAX_SENTENCE 96U       /*!< Longest accepted body, '$' and checksum excluded (NMEA allows 79) */
+#define NMEA_MAX_FIELDS 24U         /*!< Fields per sentence, the address included */
+#define NMEA_ADDRESS_SIZE 5U        /*!< Talker + sentence type, e.g. "GNRMC" */
+#define NMEA_MAX_HANDLERS 8U        /*!< Capacity of the handler table */
+#define NMEA_COORDINATE_SCALE 10000000L /*!< Coordinate units per degree (1e-7 degrees) */
+
+/**
+  * @brief  A validated sentence.
+  *         Field 0 is the address; the checksum is not part of any field.
+  */
+typedef struct {
+    const char *text;                 /*!< Body with the field separators replaced by '\0' */
+    uint8_t fields;                   /*!< Number of fields */
+    uint8_t offsets[NMEA_MAX_FIELDS]; /*!< Start of each field in text */
+} NMEA_Sentence;
+
+/**
+  * @brief  Sentence handler.
+  * @param  sentence: Validated sentence; only valid during the call.
+  */
+typedef void (*NMEA_Handler)(const NMEA_Sentence *sentence);
+
+/**
+  * @brief  Parser counters.
+  */
+typedef struct {
+    uint32_t bytes;          /*!< Bytes fed */
+    uint32_t sentences;      /*!< Sentences with a valid checksum */
+    uint32_t unhandled;      /*!< Valid sentences without a registered handler */
+    uint32_t checksumErrors; /*!< Sentences with a wrong checksum */
+    uint32_t framingErrors;  /*!< Sentences cut off, too long or malformed */
+} NMEA_Parser_Stats;
+
+
+/*--------------------- Function Prototypes ---------------------*/
+
+/**
+  * @brief  Clears the handler table, the partial sentence and the counters.
+  */
+void NMEA_Parser_Init(void);
+
+/**
+  * @brief  Drops the partial sentence; the next '$' starts over.
+  */
+void NMEA_Parser_Reset(void);
+
+/**
+  * @brief  Registers the handler of a sentence address, replacing an existing one.
+  * @param  address: Talker and sentence type, e.g. "GNRMC", or "--RMC" for any talker.
+  * @param  handler: Handler function, NULL removes the entry.
+  * @retval HAL_OK on success, HAL_ERROR on a bad address or a full table.
+  */
+HAL_StatusTypeDef NMEA_Parser_Register_Handler(const char *address, NMEA_Handler handler);
+
+/**
+  * @brief  Parses received bytes and calls the handlers of completed sentences.
+  * @param  data:   Received bytes.
+  * @param  length: Number of bytes.
+  */
+void NMEA_Parser_Feed(const uint8_t *data, uint16_t length);
+
+/**
+  * @brief  Returns a field of a sentence.
+  * @param  sentence: Sentence passed to a handler.
+  * @param  index:    Field index, 0 = address.
+  * @retval Null-terminated field, "" if it is empty or does not exist.
+  */
+const char *NMEA_Parser_Field(const NMEA_Sentence *sentence, uint8_t index);
+
+/**
+  * @brief  Converts a decimal field to a scaled integer, e.g. "22.4" with
+  *         2 decimals gives 2240. Further decimals are truncated.
+  * @param  text:     Field text.
+  * @param  decimals: Number of decimals kept, 0..6.
+  * @param  value:    Destination for the scaled value.
+  * @retval HAL_OK on success, HAL_ERROR on an empty, malformed or too large field.
+  */
+HAL_StatusTypeDef NMEA_Parser_To_Fixed(const char *text, uint8_t decimals, int32_t *value);
+
+/**
+  * @brief  Converts an NMEA coordinate ("ddmm.mmmmm" or "dddmm.mmmmm") and its
+  *         hemisphere field to 1e-7 degrees, S and W being negative.
+  * @param  text:       Coordinate field.
+  * @param  hemisphere: Hemisphere field, "N", "S", "E" or "W".
+  * @param  value:      Destination in 1e-7 degrees.
+  * @retval HAL_OK on success, HAL_ERROR on an empty or malformed field.
+  */
+HAL_StatusTypeDef NMEA_Parser_To_Coordinate(const char *text, const char *hemisphere, int32_t *value);
+
+/**
+  * @brief  Copies the parser counters.
+  * @param  stats: Destination structure.
+  */
+void NMEA_Parser_Get_Stats(NMEA_Parser_Stats *stats);
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Result of NMEA_Parser_Benchmark().
+  */
+typedef struct {
+    uint32_t cyclesPerByte;      /*!< Average CPU cycles per byte fed */
+    uint32_t cyclesPerSentence;  /*!< Average CPU cycles per sentence */
+    uint32_t sentencesPerSecond; /*!< Throughput at the current core clock */
+} NMEA_ParserBenchmark;
+
+/**
+  * @brief  Feeds typical RMC, GGA and GSA sentences and measures the parser.
+  * @param  iterations: Passes over the sample sentences (averaged).
+  * @param  result:     Destination for the measurement.
+  * @note   Handlers are not called and the counters are not changed.
+  */
+void NMEA_Parser_Benchmark(uint32_t iterations, NMEA_ParserBenchmark *result);
+
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+#endif // NMEA_PARSER
@@ -12,8 +12,14 @@
  * a Nextion display using STM32 HAL UART libraries.
  *
  * It includes:
- *  - Sending pre-defined string commands to control dashboard elements
- *  - Sending numeric values (e.g., speed, battery) to corresponding objects
+ *  - A registry of widget descriptors (source, encoder, scaling, cached value)
+ *  - A dirty bitmap so a refresh only encodes the widgets that changed
+ *  - Per-widget deadband and rate limiting for noisy values
+ *  - A priority-ordered scheduler bounded by the link's per-refresh byte budget
+ *  - Flow control driven by the display's serial buffer overflow response
+ *  - Budgeted state replay after the display reboots
+ *  - An optional binary frame mode using Nextion protocol reparse
+ *  - Standard encoders for numbers, progress bars and state icons
  *  - Handling UI updates like gear state, signals, warnings, and progress bars
  *
  * Designed for use with STM32CubeIDE and STM32 HAL libraries.
@@ -35,142 +41,157 @@
 #include "dashboard_controls.h"
 
 
-/* Private types -------------------------------------------------------------*/
-
-/**
-  * @brief  Enumeration of static commands for Nextion display control.
-  */
-typedef enum {
-    CONNECTION_OK                 = 0x00U, /*!< Connection established */
+/* Private constants ---------------------------------------------------------*/
 
-    SET_GEAR_DRIVE                = 0x01U, /*!< Set gear to Drive */
-    SET_GEAR_NEUTRAL              = 0x02U, /*!< Set gear to Neutral */
-    SET_GEAR_REVERSE              = 0x03U, /*!< Set gear to Reverse */
+#define NEX_WIDGET_WORDS (NEX_MAX_WIDGETS / 32U)   /*!< 32-bit words in the dirty bitmap */
 
-    SET_HANDBREAK_ON              = 0x04U, /*!< Handbrake engaged */
-    SET_HANDBREAK_OFF             = 0x05U, /*!< Handbrake released */
+#define NEX_STRINGIFY(x) #x
+#define NEX_TO_STRING(x) NEX_STRINGIFY(x)
 
-    SET_SIGNAL_LEFT_ON            = 0x06U,
-    SET_SIGNAL_LEFT_OFF           = 0x07U,
-    SET_SIGNAL_RIGHT_ON           = 0x08U,
-    SET_SIGNAL_RIGHT_OFF          = 0x09U,
+/**
+ * @brief "xpic <x>,<y>,<w>,<h>," of the map window; x0, y0 and the picture follow.
+ */
+#define NEX_MAP_CROP_PREFIX "xpic " NEX_TO_STRING(NEX_MAP_VIEW_X) "," NEX_TO_STRING(NEX_MAP_VIEW_Y) "," \
+                            NEX_TO_STRING(NEX_MAP_VIEW_W) "," NEX_TO_STRING(NEX_MAP_VIEW_H) ","
 
-    SET_CONNECTION_WARNING_ON     = 0x0AU,
-    SET_CONNECTION_WARNING_OFF    = 0x0BU,
-    SET_BATTERY_WARNING_ON        = 0x0CU,
-    SET_BATTERY_WARNING_OFF       = 0x0DU,
+/**
+ * @brief Handshake reply sent to the display once "OK" is received.
+ */
+static const char NEX_CONNECTION_COMMAND[] = "con=1";
 
-    SET_LIGHTS_ON                 = 0x0EU,
-    SET_LIGHTS_OFF                = 0x0FU
+/**
+ * @brief Makes the display resume sending "OK" so the handshake can be repeated.
+ */
+static const char NEX_RECONNECT_COMMAND[] = "con=0";
 
-} NEX_CommandID;
+/**
+ * @brief Asks the display for its current page (0x66); used as a link probe.
+ */
+static const char NEX_PROBE_COMMAND[] = "sendme";
 
+/**
+ * @brief Prefix of the (non-persistent) Nextion baud rate command.
+ */
+static const NEX_Prefix NEX_BAUD_COMMAND = NEX_PREFIX("baud=");
 
 /**
-  * @brief  Enumeration of numeric/value-based commands for Nextion display.
-  */
-typedef enum {
-    SET_SPEED_COMMAND             = 0x00U, /*!< Update speed value */
+ * @brief Page switch command, followed by the page ID.
+ */
+static const NEX_Prefix NEX_PAGE_COMMAND = NEX_PREFIX("page ");
 
-    SET_BATTERY_NUMBER_COMMAND    = 0x01U, /*!< Update battery percentage */
-    SET_BATTERY_PROGRESS_BAR_COMMAND = 0x02U, /*!< Update battery bar */
+/**
+ * @brief Transparent transfer into a waveform: "addt <id>,<channel>,<count>".
+ */
+static const NEX_Prefix NEX_ADDT_COMMAND = NEX_PREFIX("addt ");
 
-    SET_KW_NUMBER_COMMAND         = 0x03U, /*!< Update power kW value */
-    SET_KW_PROGRESS_BAR_COMMAND   = 0x04U, /*!< Update kW bar */
+/**
+ * @brief Redraw suppression around a frame; the display renders once at ref_star.
+ */
+static const char NEX_REDRAW_STOP[] = "ref_stop";
+static const char NEX_REDRAW_START[] = "ref_star";
 
-    SET_PACK_VOLTAGE              = 0x05U, /*!< Update total voltage */
-    SET_MAX_VOLTAGE               = 0x06U, /*!< Update max cell voltage */
-    SET_MIN_VOLTAGE               = 0x07U, /*!< Update min cell voltage */
+/**
+ * @brief Trail segment: "line <x1>,<y1>,<x2>,<y2>,<color>".
+ */
+static const NEX_Prefix NEX_LINE_COMMAND = NEX_PREFIX("line ");
 
-    SET_BATTERY_TEMPERATURE       = 0x08U, /*!< Update battery temperature */
+#if !NEX_MAP_CROP
+/**
+ * @brief Repaints the map picture, which erases the trail lines on it.
+ */
+static const char NEX_TRAIL_ERASE[] = "ref pMap";
+#endif
 
-    SET_MAP_X                     = 0x09U, /*!< Update map X position */
-    SET_MAP_Y                     = 0x0AU, /*!< Update map Y position */
-    SET_MAP_ICON                  = 0x0BU, /*!< Update vehicle icon rotation */
-    SET_MAP_LAP                   = 0x0CU  /*!< Update lap counter */
-} NEX_Int_Command_ID;
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+ * @brief Map updates of both rendering modes, for NEX_Benchmark_Map().
+ */
+static const NEX_Prefix NEX_MAP_X_COMMAND = NEX_PREFIX("pMap.x=");
+static const NEX_Prefix NEX_MAP_Y_COMMAND = NEX_PREFIX("pMap.y=");
+static const NEX_Prefix NEX_MAP_CROP_COMMAND = NEX_PREFIX(NEX_MAP_CROP_PREFIX);
+#endif
 
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+ * @brief Acknowledge every instruction (0x01 on success) / only failures (default).
+ */
+static const char NEX_BKCMD_ALWAYS[] = "bkcmd=3";
+static const char NEX_BKCMD_DEFAULT[] = "bkcmd=2";
+#endif
 
 /**
-  * @brief  Enumeration for progress bar direction on the display.
-  */
-typedef enum {
-    PROGRESS_BAR_REVERSE          = 0x01U, /*!< Progress bar from full to empty */
-    PROGRESS_BAR_NO_REVERSE       = 0x02U  /*!< Progress bar from empty to full */
-} NEX_ProgressBar_Rotation;
+ * @brief Enters protocol reparse mode; the display stops parsing commands.
+ */
+static const char NEX_RECMOD_COMMAND[] = "recmod=1";
 
-/* Private variables ---------------------------------------------------------*/
+/**
+ * @brief Fixed string that makes the display leave protocol reparse mode.
+ */
+static const char NEX_RECMOD_EXIT[] = "DRAKJHSUYDGBNCJHGJKSHBDN";
 
 /**
- * @brief Static Nextion command strings for various dashboard controls.
- *
- * These strings are sent as-is to the Nextion display to set icons,
- * visibility, or states for gears, handbrake, signals, warnings, and lights.
- */
-static const char *NEX_Command[] = {
-    /* Handshake command */
-    "con=1",
-
-    /* Gear Display commands */
-    "pGr.pic=13",     // Drive gear icon
-    "pGr.pic=14",     // Neutral gear icon
-    "pGr.pic=15",     // Reverse gear icon
-
-    /* Handbrake commands */
-    "pHb.aph=127",    // Handbrake engaged (opaque)
-    "pHb.aph=0",      // Handbrake released (transparent)
-
-    /* Signal Lights commands */
-    "pSL.aph=127",    // Left signal ON
-    "pSL.aph=0",      // Left signal OFF
-    "pSR.aph=127",    // Right signal ON
-    "pSR.aph=0",      // Right signal OFF
-
-    /* Warning Indicators commands */
-    "pCW.aph=127",    // Connection warning ON
-    "pCW.aph=0",      // Connection warning OFF
-    "pBW.aph=127",    // Battery warning ON
-    "pBW.aph=0",      // Battery warning OFF
-
-    /* Lights commands */
-    "pLt.aph=127",    // Lights ON
-    "pLt.aph=0",      // Lights OFF
+ * @brief Baud rates accepted by the Nextion "baud=" command, fastest first.
+ */
+static const uint32_t NEX_Baud_Rates[] = {
+    921600, 512000, 256000, 250000, 230400, 115200
 };
 
-
+#if !NEX_PACK_INDICATORS
 /**
- * @brief Parameterized Nextion command strings for numeric values.
- *
- * These strings contain format specifiers for integer values (%d),
- * which will be replaced by actual data before sending.
+ * @brief Picture IDs of the gear icon, indexed by NEX_Gears.
  */
-static const char *NEX_Int_Command[] = {
+static const int16_t NEX_Gear_Pictures[] = {
+    14,     // NEX_GEAR_NEUTRAL → "pGr.pic=14"
+    13,     // NEX_GEAR_DRIVE   → "pGr.pic=13"
+    15      // NEX_GEAR_REVERSE → "pGr.pic=15"
+};
 
-    /* Speed Display */
-    "nSd.val=%d",      // Speed number (km/h)
+/**
+ * @brief Icon transparency, indexed by NEX_State (OFF = transparent, ON = opaque).
+ */
+static const int16_t NEX_Indicator_Alpha[] = {
+    0,      // NEX_STATE_OFF → ".aph=0"
+    127     // NEX_STATE_ON  → ".aph=127"
+};
+#endif
 
-    /* Battery Display */
-    "nBt.val=%d",      // Battery value (number)
-    "jBt.val=%d",      // Battery progress bar (percentage)
+#if NEX_DISPLAY_BLINK
+/**
+ * @brief Blink timer interval, registered as a widget so it is replayed after a reboot.
+ */
+static const int NEX_Blink_Period = NEX_BLINK_PERIOD_MS;
+#endif
 
-    /* Power Display */
-    "nKW.val=%d",      // Power in kW
-    "jKW.val=%d",      // Power progress bar
+/* Private types -------------------------------------------------------------*/
 
-    /* Voltage Display */
-    "xBV.val=%d",      // Total battery voltage
-    "xBMa.val=%d",     // Maximum battery voltage
-    "xBMi.val=%d",     // Minimum battery voltage
+/**
+  * @brief  Waveform channel with its pending samples.
+  */
+typedef struct {
+    NEX_WaveformConfig config;
+    uint8_t samples[NEX_WAVE_BUFFER_SIZE];   /*!< Ring of scaled samples */
+    uint8_t first;             /*!< Index of the oldest pending sample */
+    uint8_t count;             /*!< Pending samples */
+    uint32_t lastSampleTick;   /*!< Tick of the last sample slot */
+    uint32_t lastFlushTick;    /*!< Tick of the last transfer */
+} NEX_Waveform;
 
-    /* Battery Temperature */
-    "xBtT.val=%d",     // Battery temperature
+/**
+  * @brief  Registry entry: descriptor plus the value last sent to the display.
+  */
+typedef struct {
+    NEX_WidgetConfig config;   /*!< Copy of the registered descriptor */
+    int32_t cached;            /*!< Value last accepted into a frame */
+    int32_t shown;             /*!< Display value last accepted into a frame */
+    int32_t lastSeen;          /*!< Source value at the previous scan */
+    uint32_t lastSendTick;     /*!< HAL tick of the last send */
+    uint32_t lastChangeTick;   /*!< HAL tick at which lastSeen was first read */
+    uint32_t dirtyTick;        /*!< HAL tick at which the widget was marked dirty */
+    uint8_t rejected;          /*!< 1 while the encoder rejects the current source value */
+    NEX_WidgetStats stats;     /*!< Sent / suppressed counters */
+} NEX_Widget;
 
-    /* Map Controls */
-    "pMap.x=%d",       // Map X coordinate
-    "pMap.y=%d",       // Map Y coordinate
-    "zIc.val=%d",      // Icon direction
-    "nLap.val=%d"      // Lap counter
-};
+/* Private variables ---------------------------------------------------------*/
 
 /**
  * @brief Pointer to the UART handle used for Nextion communication.
@@ -183,25 +204,183 @@ static UART_HandleTypeDef *_uart;
 static NEX_Data *_dashboard = NULL;
 
 /**
- * @brief Cache structure holding previous dashboard values to avoid redundant UART transmissions.
+ * @brief Widget registry.
+ */
+static NEX_Widget _widgets[NEX_MAX_WIDGETS];
+
+/**
+ * @brief Number of registered widgets.
+ */
+static uint8_t _widgetCount = 0;
+
+/**
+ * @brief One bitmap per priority class, one bit per widget, set while the
+ *        display shows a stale value.
+ */
+static uint32_t _dirty[NEX_PRIORITY_COUNT][NEX_WIDGET_WORDS];
+
+/**
+ * @brief One bit per widget on the active page or NEX_PAGE_GLOBAL.
+ *        Dirty widgets outside this mask are not sent.
+ */
+static uint32_t _visible[NEX_WIDGET_WORDS];
+
+static uint8_t _activePage = NEX_PAGE_DASHBOARD;  /*!< Page shown on the display */
+
+/**
+ * @brief Set by the RX handler when the display reported its current page.
+ */
+static volatile uint8_t _pageReported = 0;
+static volatile uint8_t _reportedPage = 0;
+
+/**
+ * @brief Maximum size of one refresh frame in bytes.
+ */
+static uint16_t _budget = NEX_FRAME_BUFFER_SIZE;
+
+/**
+ * @brief NEX_Refresh() call period the byte budget is derived from.
+ */
+static uint32_t _refreshPeriodMs = NEX_REFRESH_PERIOD_MS;
+
+/**
+ * @brief Waveform channels and the state of the current addt transfer.
+ */
+static NEX_Waveform _waveforms[NEX_MAX_WAVEFORMS];
+static uint8_t _waveformCount = 0;
+static uint8_t _waveCursor = 0;        /*!< Next channel considered for a transfer */
+static uint8_t _waveWaiting = 0;       /*!< 1 between "addt" and the sample bytes */
+static uint8_t _waveActive = 0;        /*!< Channel of the current transfer */
+static uint8_t _waveQuantity = 0;      /*!< Samples announced by the current "addt" */
+static uint32_t _waveLineErrors = 0;   /*!< RX line error count when the current "addt" was queued */
+static volatile uint8_t _waveReady = 0;  /*!< Set by the RX handler on 0xFE */
+static volatile uint8_t _waveRefused = 0;  /*!< Set by the RX handler on an invalid component / variable */
+static NEX_WaveformStats _waveStats = {0};
+
+static uint32_t _resyncPeriodMs = NEX_RESYNC_PERIOD_MS;  /*!< 0 = background resync off */
+static uint8_t _resyncCursor = 0;     /*!< Next widget the resync sweep looks at */
+
+/**
+ * @brief Set by the RX handler when the display reported a buffer overflow.
+ */
+static volatile uint8_t _overflowPending = 0;
+
+/**
+ * @brief Set by the RX handlers when the display reported a (re)start,
+ *        together with the tick of the message.
+ */
+static volatile uint8_t _rebootPending = 0;
+static volatile uint32_t _rebootTick = 0;
+
+/**
+ * @brief One bit per widget not yet replayed since the last display reboot.
+ */
+static uint32_t _restorePending[NEX_WIDGET_WORDS];
+
+static uint8_t _reconnectPending = 0;  /*!< "con=1" must be sent at the head of the next frame */
+
+/**
+ * @brief Link supervision after a baud rate upgrade. A rebooted display
+ *        returns at _baseBaud, where its messages cannot be read at
+ *        _upgradeBaud.
+ */
+static uint32_t _baseBaud = 0;          /*!< Rate before the first upgrade (power-on rate) */
+static uint32_t _upgradeBaud = 0;       /*!< Rate reached by NEX_Upgrade_Baud(), 0 = not upgraded */
+static uint32_t _lineErrors = 0;        /*!< NEX_Rx_Stats.lineErrors at the last check */
+static uint32_t _probeTick = 0;         /*!< Tick the last "sendme" probe was queued */
+static volatile uint8_t _probePending = 0;  /*!< 1 until the probe is answered (0x66) */
+static volatile uint8_t _restoreBaud = 0;   /*!< 1 once the display is ready at _baseBaud */
+static uint8_t _linkLost = 0;           /*!< 1 while waiting at _baseBaud for the display */
+
+/**
+ * @brief Reboot recovery counters reported through NEX_Get_Recovery_Stats().
+ */
+static NEX_RecoveryStats _recoveryStats = {0};
+
+static uint8_t _atomicFrames = 0;    /*!< 1 to wrap ASCII frames in ref_stop / ref_star */
+static uint8_t _binaryMode = 0;      /*!< 1 while the display is in protocol reparse mode */
+
+/**
+ * @brief Wire size comparison reported through NEX_Get_Wire_Stats().
+ */
+static NEX_WireStats _wireStats = {0};
+
+/**
+ * @brief Trail drawing state. Segments are named by the sequence number of
+ *        their end vertex (Map_Trail_Stats.vertices counts every vertex ever
+ *        added), so a pass survives vertices dropping out of the ring.
+ */
+static uint8_t _trailEnabled = NEX_MAP_TRAIL;
+static uint8_t _trailRedraw = 0;      /*!< 1: full redraw due regardless of NEX_TRAIL_REDRAW_MS */
+static uint8_t _trailErase = 0;       /*!< 1: "ref pMap" due before the next segment */
+static int32_t _trailNext = 0;        /*!< End vertex of the next segment to draw, counting down */
+static int32_t _trailStop = 0;        /*!< Oldest end vertex of the current pass */
+static int _trailOffsetX = 0;         /*!< Map offset of the last full redraw */
+static int _trailOffsetY = 0;
+static int _trailLap = 0;             /*!< Lap the drawn trail belongs to */
+static uint8_t _mapWidget = 0;        /*!< ID of the crop widget (NEX_MAP_CROP) */
+static uint32_t _trailVertices = 0;   /*!< Map_Trail_Stats.vertices at the last refresh */
+static uint32_t _trailChanges = 0;    /*!< vertices + merged at the last refresh */
+static uint32_t _trailTick = 0;       /*!< Tick of the last full redraw */
+
+static uint8_t _throttleShift = 0;   /*!< Frame budget is _budget >> _throttleShift */
+static uint8_t _cleanFrames = 0;     /*!< Refreshes since the last overflow or budget step */
+
+/**
+ * @brief Scheduling counters per priority class.
  */
-static NEX_CachedData _previousValues = {0};
+static NEX_PriorityStats _priorityStats[NEX_PRIORITY_COUNT];
 
 /**
- * @brief Nextion command terminator: 3-byte sequence required to mark end of commands.
+ * @brief Order in which the priority classes are served.
  */
-static const uint8_t COMMAND_END[3] = {0xFF, 0xFF, 0xFF};
-/* Private Constants ---------------------------------------------------------*/
-/* Private macros ------------------------------------------------------------*/
+static const NEX_Priority NEX_Priority_Order[NEX_PRIORITY_COUNT] = {
+    NEX_PRIORITY_CRITICAL,
+    NEX_PRIORITY_HIGH,
+    NEX_PRIORITY_NORMAL,
+    NEX_PRIORITY_LOW
+};
+
 /* Private function prototypes -----------------------------------------------*/
 /** @addtogroup Dashboard_Private_Functions
   * @{
   */
-static void Send_Nextion_Command(NEX_CommandID cmdID);
-static void Send_String_To_Nextion(char *str);
-static void Send_Nextion_Int(NEX_Int_Command_ID cmdID, int val);
-static HAL_StatusTypeDef Send_Nextion_Progress_Bar(NEX_Int_Command_ID cmdID, int val, int maxVal, int minVal, NEX_ProgressBar_Rotation reverseProgressBar);
-static void Command_Terminator(void);
+static HAL_StatusTypeDef Register_Standard_Widgets(NEX_Data *data);
+static void Scan_Widgets(void);
+static uint8_t Filter_Allows(NEX_Widget *widget, int32_t value, uint32_t now);
+static void Set_Dirty(uint8_t id, uint32_t now);
+static HAL_StatusTypeDef Send_Dirty_Widgets(void);
+static HAL_StatusTypeDef Send_Widget(uint8_t id);
+static HAL_StatusTypeDef Append_Widget(const NEX_WidgetConfig *config, int32_t value, int32_t display);
+static uint16_t Widget_Size(const NEX_WidgetConfig *config, int32_t value, int32_t display);
+static const char *Widget_Text(const NEX_WidgetConfig *config, int32_t value);
+static void Resync_Widgets(void);
+static void Mark_Sent(uint8_t id, int32_t value, int32_t display, uint32_t now);
+static void Reject_Widget(uint8_t id);
+static HAL_StatusTypeDef Send_Binary_Frame(void);
+static uint8_t Any_Dirty(void);
+static HAL_StatusTypeDef Send_Mode_Command(const char *command);
+static uint8_t Baud_Is_Reachable(uint32_t baudRate);
+static HAL_StatusTypeDef Switch_Baud(uint32_t baudRate);
+static HAL_StatusTypeDef Set_Uart_Baud(uint32_t baudRate);
+static HAL_StatusTypeDef Verify_Link(uint32_t timeout);
+static void Check_Link(void);
+static void Recover_Link(void);
+static void Flag_Reboot(uint32_t tick);
+static void Mark_All_Dirty(void);
+static uint16_t Throttled_Budget(void);
+static void Overflow_Handler(uint8_t code, const NEX_RxView *payload);
+static void Reboot_Handler(uint8_t code, const NEX_RxView *payload);
+static void Track_Recovery(void);
+static void Page_Handler(uint8_t code, const NEX_RxView *payload);
+static void Transfer_Handler(uint8_t code, const NEX_RxView *payload);
+static void Sample_Waveforms(void);
+static HAL_StatusTypeDef Service_Waveforms(void);
+static HAL_StatusTypeDef Finish_Transfer(uint8_t blind);
+static void Set_Active_Page(uint8_t page);
+static void Send_Trail(void);
+static uint8_t Clip_Segment(int32_t *line);
+static void Crop_Arguments(const NEX_WidgetConfig *config, int32_t display, int32_t *args);
 /**
   * @}
   */
@@ -234,6 +413,9 @@ HAL_StatusTypeDef NEX_Init(UART_HandleTypeDef *uart, NEX_Data *data)
   *
   * @note   This function must be called before using any display-related operations.
   *         Passing NULL pointers will result in HAL_ERROR being returned.
+  *         The UART is also bound to the TX queue (NEX_Link_Init()) and the
+  *         receiver (NEX_Rx_Init()), the widget registry is cleared and the
+  *         standard dashboard widgets are registered.
   */
 HAL_StatusTypeDef NEX_Bind(UART_HandleTypeDef *uart, NEX_Data *data)
 {
@@ -242,144 +424,163 @@ HAL_StatusTypeDef NEX_Bind(UART_HandleTypeDef *uart, NEX_Data *data)
 
 	_uart = uart;
     _dashboard = data;
+
+    _widgetCount = 0;
+    memset(_dirty, 0, sizeof(_dirty));
+    memset(_visible, 0, sizeof(_visible));
+    _activePage = NEX_PAGE_DASHBOARD;
+    _pageReported = 0;
+    _resyncPeriodMs = NEX_RESYNC_PERIOD_MS;
+    _resyncCursor = 0;
+    _waveformCount = 0;
+    _waveCursor = 0;
+    _waveWaiting = 0;
+    memset(&_waveStats, 0, sizeof(_waveStats));
+    NEX_Reset_Priority_Stats();
+    _overflowPending = 0;
+    _throttleShift = 0;
+    _cleanFrames = 0;
+    _rebootPending = 0;
+    _reconnectPending = 0;
+    _baseBaud = _upgradeBaud = 0;
+    _probePending = _restoreBaud = _linkLost = 0;
+    memset(_restorePending, 0, sizeof(_restorePending));
+    memset(&_recoveryStats, 0, sizeof(_recoveryStats));
+    memset(&_wireStats, 0, sizeof(_wireStats));
+    _binaryMode = 0;
+    _trailEnabled = NEX_MAP_TRAIL;
+    _trailRedraw = 1;
+    _trailErase = 0;
+    _trailNext = _trailStop = 0;
+    _trailLap = (data->mapData != NULL) ? data->mapData->Lap : 0;
+    _trailVertices = _trailChanges = 0;
+
+    if (Register_Standard_Widgets(data) != HAL_OK ||
+        NEX_Set_Refresh_Period(NEX_REFRESH_PERIOD_MS) != HAL_OK ||
+        NEX_Link_Init(uart) != HAL_OK ||
+        NEX_Rx_Init(uart) != HAL_OK)
+        return HAL_ERROR;
+
+    if (NEX_Rx_Register_Handler(NEX_RX_BUFFER_OVERFLOW, Overflow_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_READY, Reboot_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_INVALID_INSTRUCTION, Reboot_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_CURRENT_PAGE, Page_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_TRANSPARENT_READY, Transfer_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_INVALID_COMPONENT, Transfer_Handler) != HAL_OK ||
+        NEX_Rx_Register_Handler(NEX_RX_INVALID_VARIABLE, Transfer_Handler) != HAL_OK)
+        return HAL_ERROR;
+
     return HAL_OK;
 }
 
 /**
   * @brief  Refreshes the Nextion display with updated system data.
   *
-  *         This function checks each runtime variable stored in the dashboard structure.
-  *         If the new value differs from the previously sent one, it transmits the update
-  *         via UART using the appropriate Nextion command. This selective update reduces
-  *         unnecessary UART traffic.
+  *         Every widget source is compared with the value last sent and the
+  *         dirty bit of each changed widget is set. Only the set bits are then
+  *         walked (count-trailing-zeros per bitmap word), so the encoding cost
+  *         scales with the number of changed widgets, not the registry size.
+  *
+  *         The bitmaps are walked one priority class at a time, CRITICAL first.
+  *         All commands are assembled into one frame (see nex_frame.h) limited
+  *         to the byte budget of one refresh period, and handed to the TX queue
+  *         in a single write. A widget is only marked clean once its command fits
+  *         into the frame, so a deferred update is retried on the next call. The
+  *         size of the last frame is reported by NEX_Frame_Get_Info().
+  *
+  *         While the previous frame is still in the TX queue no new frame is
+  *         built: changed widgets only stay dirty, and the next frame carries
+  *         their newest values (last writer wins).
   *
-  * @note   Must be called periodically inside the main loop or a task.
-  * @retval HAL_OK on full success, HAL_ERROR if any UART failure occurs.
+  * @note   Must be called periodically inside the main loop or a task, at the
+  *         period given to NEX_Set_Refresh_Period().
+  * @retval HAL_OK on full success, HAL_BUSY if the link is still busy or an
+  *         update was deferred by the byte budget, HAL_ERROR if a command was
+  *         rejected or the frame could not be queued.
   */
 HAL_StatusTypeDef NEX_Refresh(void)
 {
+    HAL_StatusTypeDef status = HAL_OK;
 
-    /* Numeric values */
-    if (*_dashboard->speed != _previousValues.speed) {
-        Send_Nextion_Int(SET_SPEED_COMMAND, *_dashboard->speed);
-        _previousValues.speed = *_dashboard->speed;
-    }
-
-    if (*_dashboard->batteryValue != _previousValues.batteryValue) {
-        Send_Nextion_Int(SET_BATTERY_NUMBER_COMMAND, *_dashboard->batteryValue);
-
-        if (Send_Nextion_Progress_Bar(SET_BATTERY_PROGRESS_BAR_COMMAND, *_dashboard->batteryValue,
-        		NEX_BATTERY_PROGRESS_BAR_MAX_VAL, NEX_BATTERY_PROGRESS_BAR_MIN_VAL, PROGRESS_BAR_NO_REVERSE) == HAL_ERROR)
-             return HAL_ERROR;
-        _previousValues.batteryValue = *_dashboard->batteryValue;
-    }
-
-
-    if (*_dashboard->powerKW != _previousValues.powerKW) {
-        Send_Nextion_Int(SET_KW_NUMBER_COMMAND, *_dashboard->powerKW);
-
-        if (Send_Nextion_Progress_Bar(SET_KW_PROGRESS_BAR_COMMAND, *_dashboard->powerKW,
-        		NEX_KW_PROGRESS_BAR_MAX_VAL, NEX_KW_PROGRESS_BAR_MIN_VAL, PROGRESS_BAR_REVERSE) == HAL_ERROR)
-            return HAL_ERROR;
-        _previousValues.powerKW = *_dashboard->powerKW;
-    }
-
-
-    if (*_dashboard->packVoltage != _previousValues.packVoltage) {
-        Send_Nextion_Int(SET_PACK_VOLTAGE, *_dashboard->packVoltage);
-        _previousValues.packVoltage = *_dashboard->packVoltage;
-    }
-
-    if (*_dashboard->maxVoltage != _previousValues.maxVoltage) {
-        Send_Nextion_Int(SET_MAX_VOLTAGE, *_dashboard->maxVoltage);
-        _previousValues.maxVoltage = *_dashboard->maxVoltage;
-    }
-
-    if (*_dashboard->minVoltage != _previousValues.minVoltage) {
-        Send_Nextion_Int(SET_MIN_VOLTAGE, *_dashboard->minVoltage);
-        _previousValues.minVoltage = *_dashboard->minVoltage;
-    }
+    if (_dashboard == NULL)
+        return HAL_ERROR;
 
-    if (*_dashboard->batteryTemp != _previousValues.batteryTemp) {
-        Send_Nextion_Int(SET_BATTERY_TEMPERATURE, *_dashboard->batteryTemp);
-        _previousValues.batteryTemp = *_dashboard->batteryTemp;
+    NEX_Link_Service();     // Resume draining if an overflow pause has expired
+    Check_Link();
+    Track_Recovery();
+    if (_pageReported) {
+        _pageReported = 0;
+        Set_Active_Page(_reportedPage);     // Page changed on the display itself
     }
+    Scan_Widgets();
+    Sample_Waveforms();
 
-    if (_dashboard->mapData->PixelX != _previousValues.mapData.PixelX) {
-        Send_Nextion_Int(SET_MAP_X, _dashboard->mapData->PixelX);
-        _previousValues.mapData.PixelX = _dashboard->mapData->PixelX;
-    }
+    if (Service_Waveforms() != HAL_OK)
+        return HAL_BUSY;    // Display expects raw sample bytes; hold every command back
 
-    if (_dashboard->mapData->PixelY != _previousValues.mapData.PixelY) {
-        Send_Nextion_Int(SET_MAP_Y, _dashboard->mapData->PixelY);
-        _previousValues.mapData.PixelY = _dashboard->mapData->PixelY;
-    }
+    if (NEX_Link_Get_Depth() > NEX_COALESCE_BACKLOG)
+        return HAL_BUSY;    // Keep updates pending; they are coalesced until the link drains
 
-    if (_dashboard->mapData->IconAngle != _previousValues.mapData.IconAngle) {
-        Send_Nextion_Int(SET_MAP_ICON, _dashboard->mapData->IconAngle);
-        _previousValues.mapData.IconAngle = _dashboard->mapData->IconAngle;
-    }
+    NEX_Frame_Begin_Budget(Throttled_Budget());
+    if (_atomicFrames && !_binaryMode)
+        NEX_Frame_Wrap(NEX_REDRAW_STOP, NEX_REDRAW_START);    // One redraw for the whole frame
 
-    if (_dashboard->mapData->Lap != _previousValues.mapData.Lap) {
-        Send_Nextion_Int(SET_MAP_LAP, _dashboard->mapData->Lap);
-        _previousValues.mapData.Lap = _dashboard->mapData->Lap;
-    }
+    if (_reconnectPending && NEX_Frame_Append(NEX_CONNECTION_COMMAND) == HAL_OK &&
+        (!_binaryMode || NEX_Frame_Append(NEX_RECMOD_COMMAND) == HAL_OK))
+        _reconnectPending = 0;  // Answer the rebooted display's handshake first
 
-    /* Gear */
-    if (*_dashboard->gear != _previousValues.gear) {
-        switch (*_dashboard->gear) {
-            case 0: Send_Nextion_Command(SET_GEAR_NEUTRAL); break;
-            case 1: Send_Nextion_Command(SET_GEAR_DRIVE); break;
-            case 2: Send_Nextion_Command(SET_GEAR_REVERSE); break;
-        }
-        _previousValues.gear = *_dashboard->gear;
+    if (_binaryMode) {
+        status = Send_Binary_Frame();
+        if (NEX_Frame_Commit() != HAL_OK)
+            status = HAL_ERROR;
+        return status;
     }
 
-    /* Warnings */
-    if (*_dashboard->handbrake != _previousValues.handbrake) {
-        Send_Nextion_Command(*_dashboard->handbrake ? SET_HANDBREAK_ON : SET_HANDBREAK_OFF);
-        _previousValues.handbrake = *_dashboard->handbrake;
+    uint8_t probe = 0;
+    if (_upgradeBaud != 0 && _uart->Init.BaudRate == _upgradeBaud && !_probePending &&
+        HAL_GetTick() - _probeTick >= NEX_LINK_PROBE_MS && NEX_Frame_Append(NEX_PROBE_COMMAND) == HAL_OK) {
+        _probeTick = HAL_GetTick();
+        _probePending = probe = 1;  // Answered with 0x66 by a display still at this rate
     }
 
-    if (*_dashboard->signalLeft != _previousValues.signalLeft) {
-        Send_Nextion_Command(*_dashboard->signalLeft ? SET_SIGNAL_LEFT_ON : SET_SIGNAL_LEFT_OFF);
-        _previousValues.signalLeft = *_dashboard->signalLeft;
-    }
+    uint16_t binarySize = Any_Dirty() ? NEX_BINARY_OVERHEAD + 2U * _widgetCount : 0U;
+    uint16_t headerSize = NEX_Frame_Get_Size();
 
-    if (*_dashboard->signalRight != _previousValues.signalRight) {
-        Send_Nextion_Command(*_dashboard->signalRight ? SET_SIGNAL_RIGHT_ON : SET_SIGNAL_RIGHT_OFF);
-        _previousValues.signalRight = *_dashboard->signalRight;
-    }
+    status = Send_Dirty_Widgets();
 
-    if (*_dashboard->connWarn != _previousValues.connWarn) {
-        Send_Nextion_Command(*_dashboard->connWarn ? SET_CONNECTION_WARNING_ON : SET_CONNECTION_WARNING_OFF);
-        _previousValues.connWarn = *_dashboard->connWarn;
-    }
+    uint16_t widgetSize = NEX_Frame_Get_Size() - headerSize;
 
-    if (*_dashboard->battWarn != _previousValues.battWarn) {
-        Send_Nextion_Command(*_dashboard->battWarn ? SET_BATTERY_WARNING_ON : SET_BATTERY_WARNING_OFF);
-        _previousValues.battWarn = *_dashboard->battWarn;
+    if (!Any_Dirty()) {     // No update was deferred, so the rest of the budget is free
+        Resync_Widgets();   // Before the trail, so a long redraw cannot starve the sweep
+        if (_activePage == NEX_PAGE_DASHBOARD)
+            Send_Trail();   // pMap is up to date, so the lines land on the shown map
     }
 
-    if (*_dashboard->lights != _previousValues.lights) {
-        Send_Nextion_Command(*_dashboard->lights ? SET_LIGHTS_ON : SET_LIGHTS_OFF);
-        _previousValues.lights = *_dashboard->lights;
+    if (NEX_Frame_Commit() != HAL_OK) {
+        status = HAL_ERROR;
+        if (probe)
+            _probePending = 0;      // Not sent; probe again next time
+    } else if (widgetSize > 0) {
+        _wireStats.frames++;
+        _wireStats.asciiBytes += widgetSize;
+        _wireStats.binaryBytes += binarySize;
     }
 
-    return HAL_OK;
+    return status;
 }
 
 /**
   * @brief  Performs a handshake with the Nextion screen over UART.
   *
   *         The function attempts communication with the Nextion display by:
-  *         1. Listening for a 2-byte "OK" response from the display.
+  *         1. Waiting for the "OK" message from the display (seen by nex_rx.h).
   *         2. Sending a "con=1" (connection OK) command in response.
   *         3. Repeating the process up to 5 times if necessary.
   *
   * @param  timeout: Timeout duration (in milliseconds) for each receive attempt.
   *
   * @retval HAL_OK    If an "OK" is received within the allowed number of attempts.
+  * @retval HAL_BUSY  If a waveform transfer is in progress (see Service_Waveforms()).
   * @retval HAL_ERROR If no valid response is received.
   *
   * @note   Make sure `_uart` is correctly initialized before calling this function.
@@ -387,13 +588,23 @@ HAL_StatusTypeDef NEX_Refresh(void)
   */
 HAL_StatusTypeDef NEX_Handshake(uint32_t timeout)
 {
-    uint8_t rx_buffer[10]; // Buffer for receiving data
+    if (_waveWaiting)
+        return HAL_BUSY;    // "con=1" would be taken as sample data
+
+    NEX_Rx_Take_Ok();  // Discard an "OK" left over from before
 
     for (int i = 0; i < NEX_HANDSHAKE_ATTEMPTS; i++) {
-        HAL_UART_Receive(_uart, rx_buffer, 2, timeout);  // Wait for 2 bytes
-        Send_Nextion_Command(CONNECTION_OK);  // Send "con=1" command
+        uint32_t start = HAL_GetTick();
+        uint8_t ok;
+
+        while (!(ok = NEX_Rx_Take_Ok()) && HAL_GetTick() - start < timeout)
+            ;  // Wait for "OK"
+
+        NEX_Frame_Begin();
+        NEX_Frame_Append(NEX_CONNECTION_COMMAND);  // Send "con=1" command
+        NEX_Frame_Commit();
 
-        if (rx_buffer[0] == 'O' && rx_buffer[1] == 'K') {
+        if (ok) {
             return HAL_OK;  // "OK" received from screen
         }
     }
@@ -401,101 +612,1922 @@ HAL_StatusTypeDef NEX_Handshake(uint32_t timeout)
 }
 
 /**
-  * @brief  Sends a pre-defined command string to the Nextion display.
+  * @brief  Negotiates a faster baud rate with the display.
   *
-  *         Uses the given command ID to look up the corresponding string in the
-  *         NEX_Command array, and sends it using UART.
+  *         Candidate rates are taken from NEX_Baud_Rates[], fastest first, up to
+  *         maxBaudRate. For each rate the UART can generate accurately:
+  *         1. "baud=<rate>" is sent and drained at the current rate.
+  *         2. The UART is re-initialized at the new rate.
+  *         3. "con=0" restarts the display's "OK" messages and NEX_Handshake()
+  *            verifies the link.
+  *         On failure "baud=<original>" is sent at the new rate (in case the
+  *         display did switch), the UART returns to the original rate and the
+  *         link is verified again before the next candidate is tried.
   *
-  * @param  cmdID: Index of the command in the NEX_Command string array.
+  * @param  maxBaudRate: Highest rate to try.
+  * @param  timeout:     Receive timeout per handshake attempt.
+  * @retval HAL_OK if upgraded, HAL_ERROR if still at the original rate,
+  *         HAL_TIMEOUT if the display was lost, HAL_BUSY during a waveform transfer.
+  */
+HAL_StatusTypeDef NEX_Upgrade_Baud(uint32_t maxBaudRate, uint32_t timeout)
+{
+    if (_uart == NULL)
+        return HAL_ERROR;
+    if (_waveWaiting)
+        return HAL_BUSY;
+
+    uint32_t original = _uart->Init.BaudRate;
+
+    for (uint32_t i = 0; i < sizeof(NEX_Baud_Rates) / sizeof(NEX_Baud_Rates[0]); i++) {
+        uint32_t candidate = NEX_Baud_Rates[i];
+
+        if (candidate > maxBaudRate || !Baud_Is_Reachable(candidate))
+            continue;
+        if (candidate <= original)
+            break;  // Nothing faster left to try
+
+        if (Switch_Baud(candidate) == HAL_OK && Verify_Link(timeout) == HAL_OK) {
+            NEX_Rx_Stats rx;
+
+            NEX_Set_Refresh_Period(_refreshPeriodMs);
+            NEX_Rx_Get_Stats(&rx);
+            if (_baseBaud == 0)
+                _baseBaud = original;
+            _upgradeBaud = candidate;
+            _lineErrors = rx.lineErrors;
+            _probeTick = HAL_GetTick();
+            _probePending = 0;
+            return HAL_OK;
+        }
+
+        // Fall back: the display may or may not have switched
+        Switch_Baud(original);
+        if (Verify_Link(timeout) != HAL_OK)
+            return HAL_TIMEOUT;
+    }
+
+    return HAL_ERROR;
+}
+
+/**
+  * @brief  Copies a widget descriptor into the registry and marks it dirty.
+  * @param  config: Widget descriptor (prefix, read, source and encode are required).
+  * @param  id:     Receives the widget index, may be NULL.
+  * @retval HAL_OK on success, HAL_ERROR if the descriptor is incomplete or the registry is full.
+  */
+HAL_StatusTypeDef NEX_Register_Widget(const NEX_WidgetConfig *config, uint8_t *id)
+{
+    if (config == NULL || config->read == NULL || config->source == NULL ||
+        config->encode == NULL || config->priority >= NEX_PRIORITY_COUNT ||
+        _widgetCount >= NEX_MAX_WIDGETS)
+        return HAL_ERROR;
+
+    uint8_t index = _widgetCount++;
+    NEX_Widget *widget = &_widgets[index];
+    memset(widget, 0, sizeof(*widget));
+    widget->config = *config;
+    if (widget->config.settleMs == 0)
+        widget->config.settleMs = NEX_WIDGET_SETTLE_MS;
+    widget->cached = config->read(config->source);
+    widget->lastSeen = widget->cached;
+    widget->lastChangeTick = HAL_GetTick();
+    if (config->page == _activePage || config->page == NEX_PAGE_GLOBAL)
+        _visible[index / 32U] |= 1UL << (index % 32U);
+
+    NEX_Mark_Dirty(index);   // Push the initial value on the next refresh
+
+    if (id != NULL)
+        *id = index;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Sets the dirty bit of a widget so it is resent on the next refresh.
+  * @param  id: Widget index.
   * @retval None
   */
-static void Send_Nextion_Command(NEX_CommandID cmdID)
+void NEX_Mark_Dirty(uint8_t id)
+{
+    if (id < _widgetCount)
+        Set_Dirty(id, HAL_GetTick());
+}
+
+/**
+  * @brief  Copies the sent / suppressed counters of a widget.
+  * @param  id:    Widget index.
+  * @param  stats: Destination structure.
+  * @retval HAL_OK on success, HAL_ERROR if id is not registered or stats is NULL.
+  */
+HAL_StatusTypeDef NEX_Get_Widget_Stats(uint8_t id, NEX_WidgetStats *stats)
 {
-    Send_String_To_Nextion((char *)NEX_Command[cmdID]);
+    if (id >= _widgetCount || stats == NULL)
+        return HAL_ERROR;
+
+    *stats = _widgets[id].stats;
+    return HAL_OK;
 }
 
 /**
-  * @brief  Sends a null-terminated command string to the Nextion display.
+  * @brief  Derives the per-frame byte budget from the UART baud rate.
   *
-  *         After sending the command, this function automatically appends
-  *         the 0xFF 0xFF 0xFF terminator required by the Nextion protocol.
+  *         With 8N1 framing a byte takes 10 bit times, so one refresh period
+  *         carries baud / 10 * periodMs / 1000 bytes. The budget is capped by the
+  *         frame buffer; a frame never needs to be larger than the link can
+  *         drain before the next refresh.
   *
-  * @param  str: Command string to transmit (e.g., "page main").
+  * @param  periodMs: Refresh period in milliseconds.
+  * @retval HAL_OK on success, HAL_ERROR if periodMs is 0 or no UART is bound.
+  */
+HAL_StatusTypeDef NEX_Set_Refresh_Period(uint32_t periodMs)
+{
+    if (periodMs == 0 || _uart == NULL)
+        return HAL_ERROR;
+
+    uint32_t budget = (uint32_t)((uint64_t)_uart->Init.BaudRate * periodMs / 10000U);
+
+    _refreshPeriodMs = periodMs;
+
+    _budget = (budget < NEX_FRAME_BUFFER_SIZE) ? (uint16_t)budget : NEX_FRAME_BUFFER_SIZE;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Sets the background resync period.
+  * @param  periodMs: Bound in milliseconds, 0 disables the sweep.
+  * @retval None
+  */
+void NEX_Set_Resync_Period(uint32_t periodMs)
+{
+    _resyncPeriodMs = periodMs;
+}
+
+/**
+  * @brief  Returns the current per-frame byte budget.
+  */
+uint16_t NEX_Get_Frame_Budget(void)
+{
+    return _budget;
+}
+
+/**
+  * @brief  Copies the scheduling counters of a priority class.
+  * @param  priority: Priority class.
+  * @param  stats:    Destination structure.
+  * @retval HAL_OK on success, HAL_ERROR on an invalid class or NULL stats.
+  */
+HAL_StatusTypeDef NEX_Get_Priority_Stats(NEX_Priority priority, NEX_PriorityStats *stats)
+{
+    if (priority >= NEX_PRIORITY_COUNT || stats == NULL)
+        return HAL_ERROR;
+
+    *stats = _priorityStats[priority];
+    return HAL_OK;
+}
+
+/**
+  * @brief  Clears the scheduling counters of all priority classes.
+  * @retval None
+  */
+void NEX_Reset_Priority_Stats(void)
+{
+    memset(_priorityStats, 0, sizeof(_priorityStats));
+}
+
+/**
+  * @brief  Copies the display reboot recovery counters.
+  * @param  stats: Destination structure.
   * @retval None
   */
-static void Send_String_To_Nextion(char *str)
+void NEX_Get_Recovery_Stats(NEX_RecoveryStats *stats)
 {
-    HAL_UART_Transmit(_uart, (uint8_t*)str, strlen(str), HAL_MAX_DELAY);
-    Command_Terminator(); // Send 3-byte terminator at the end of the command
+    if (stats != NULL)
+        *stats = _recoveryStats;
 }
 
 /**
-  * @brief  Sends a formatted command with integer value to the Nextion display.
+  * @brief  Enters or leaves Nextion protocol reparse mode.
   *
-  *         Replaces the %d placeholder in the command string with the actual
-  *         integer value and sends it via UART. Useful for dynamic numbers.
+  *         Entering sends "recmod=1"; leaving sends the fixed exit string. The
+  *         queue is drained around the command so that no ASCII command ends up
+  *         in the binary stream or vice versa. All widgets are marked dirty so
+  *         the first frame in the new mode carries the complete state.
   *
-  * @param  cmdID: Index in NEX_Int_Command array.
-  * @param  val: Integer to inject into command string.
+  * @param  enable: 1 for binary frames, 0 for ASCII commands.
+  * @retval HAL_OK on success, HAL_BUSY during a waveform transfer, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NEX_Set_Binary_Mode(uint8_t enable)
+{
+    enable = enable ? 1U : 0U;
+    if (_uart == NULL)
+        return HAL_ERROR;
+    if (enable == _binaryMode)
+        return HAL_OK;
+    if (_waveWaiting)
+        return HAL_BUSY;
+
+    for (uint8_t id = 0; enable && id < _widgetCount; id++) {
+        if (_widgets[id].config.format == NEX_FORMAT_CROP)
+            return HAL_ERROR;   // x0 and y0 do not fit one int16 slot
+    }
+
+    if (Send_Mode_Command(enable ? NEX_RECMOD_COMMAND : NEX_RECMOD_EXIT) != HAL_OK)
+        return HAL_ERROR;
+
+    _binaryMode = enable;
+    Mark_All_Dirty();
+    return HAL_OK;
+}
+
+/**
+  * @brief  Adds a waveform channel.
+  * @param  config: Channel descriptor.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NEX_Register_Waveform(const NEX_WaveformConfig *config)
+{
+    if (config == NULL || config->read == NULL || config->source == NULL ||
+        config->sampleMs == 0 || config->inMax <= config->inMin || config->channel > 3U ||
+        _waveformCount >= NEX_MAX_WAVEFORMS)
+        return HAL_ERROR;
+
+    NEX_Waveform *wave = &_waveforms[_waveformCount++];
+    memset(wave, 0, sizeof(*wave));
+    wave->config = *config;
+    wave->lastSampleTick = HAL_GetTick();
+    wave->lastFlushTick = wave->lastSampleTick;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Copies the waveform transfer counters.
+  * @param  stats: Destination structure.
   * @retval None
   */
-static void Send_Nextion_Int(NEX_Int_Command_ID cmdID, int val)
+void NEX_Get_Waveform_Stats(NEX_WaveformStats *stats)
+{
+    if (stats != NULL)
+        *stats = _waveStats;
+}
+
+/**
+  * @brief  Switches the display to another page.
+  *
+  *         The page command is queued behind the frames already waiting, so
+  *         it reaches the display in order. From the next refresh on, only the
+  *         widgets of that page (and NEX_PAGE_GLOBAL) are sent, starting with
+  *         all of them.
+  *
+  * @param  page: Page ID.
+  * @retval HAL_OK if queued, HAL_BUSY during a waveform transfer, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NEX_Show_Page(uint8_t page)
 {
-    char command[20]; // 20-character command buffer
-    const char *cmd = NEX_Int_Command[cmdID];
-    sprintf(command, cmd, val);  // Create formatted string
-    Send_String_To_Nextion(command);  // Send via UART
+    if (_uart == NULL || _binaryMode)
+        return HAL_ERROR;   // Commands are not parsed in protocol reparse mode
+    if (_waveWaiting)
+        return HAL_BUSY;    // The command would be taken as sample data
+
+    NEX_Frame_Begin();
+    if (NEX_Frame_Append_Int(&NEX_PAGE_COMMAND, page) != HAL_OK || NEX_Frame_Commit() != HAL_OK)
+        return HAL_ERROR;
+
+    Set_Active_Page(page);
+    return HAL_OK;
 }
 
+/**
+  * @brief  Returns the active page.
+  * @retval Page ID.
+  */
+uint8_t NEX_Get_Active_Page(void)
+{
+    return _activePage;
+}
 
 /**
-  * @brief  Maps a value from the given input range to a 0-100 scale and sends it
-  *         as a progress bar update command to the Nextion display.
+  * @brief  Enables or disables redraw suppression around each ASCII frame.
   *
-  *         If reverseProgressBar is set, the mapped value is inverted (100 - mapped value).
+  *         The frame starts with "ref_stop" and ends with "ref_star", so all
+  *         widgets of one refresh (e.g. pMap.x and pMap.y) are drawn together.
+  *         Frames with no widget inside are not sent. If the closing command is
+  *         lost the screen stays frozen until the next frame or a reboot.
   *
-  * @param  cmdID:             Identifier for the progress bar command string containing a %d placeholder.
-  * @param  val:               The current data value to be visualized.
-  * @param  maxVal:            Maximum boundary of the input range.
-  * @param  minVal:            Minimum boundary of the input range.
-  * @param  reverseProgressBar: Direction control for progress bar:
-  *                             - PROGRESS_BAR_REVERSE: Invert progress bar fill.
-  *                             - PROGRESS_BAR_NO_REVERSE: Normal progress bar fill.
+  * @param  enable: 1 to wrap frames, 0 to send commands as they are.
+  * @retval None
+  */
+void NEX_Set_Atomic_Frames(uint8_t enable)
+{
+    _atomicFrames = enable ? 1U : 0U;
+}
+
+/**
+  * @brief  Enables or disables the driven-path trail.
   *
-  * @retval HAL_OK if val is inside the range and the command is sent successfully.
-  * @retval HAL_ERROR if val is outside the specified range.
+  *         Enabling draws the whole trail on the next refresh. Disabling
+  *         repaints the map once ("ref pMap") to remove the drawn lines.
   *
-  * @note   Uses Map_Int() to scale the input value to 0-100.
+  * @param  enable: 1 to draw the trail, 0 to erase it.
+  * @retval None
   */
-static HAL_StatusTypeDef Send_Nextion_Progress_Bar(NEX_Int_Command_ID cmdID, int val, int maxVal, int minVal, NEX_ProgressBar_Rotation reverseProgressBar)
+void NEX_Set_Trail(uint8_t enable)
 {
-    if (minVal <= val && val <=maxVal){
-    	int mapVal;
-    	if(reverseProgressBar == PROGRESS_BAR_REVERSE)
-    		mapVal = 100 - Map_Int(val, minVal, maxVal, 0, 100);  // Map to 0-100 range
-    	else if(reverseProgressBar == PROGRESS_BAR_NO_REVERSE)
-    		mapVal = Map_Int(val, minVal, maxVal, 0, 100);
+    if (enable && !_trailEnabled)
+        _trailRedraw = 1;
+    else if (!enable && _trailEnabled)
+        _trailErase = 1;
 
-        Send_Nextion_Int(cmdID, (uint8_t)mapVal);
-        return HAL_OK;
-    } else {
-        return HAL_ERROR;  // Value out of range
-    }
+    _trailEnabled = enable ? 1U : 0U;
+}
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+ * @brief Success responses counted by NEX_Benchmark_Render().
+ */
+static volatile uint16_t _acks = 0;
+
+/**
+  * @brief  Counts instruction acknowledgments (0x01) during the benchmark.
+  * @param  code:    NEX_RX_SUCCESS.
+  * @param  payload: Empty.
+  * @retval None
+  */
+static void Ack_Handler(uint8_t code, const NEX_RxView *payload)
+{
+    (void)code;
+    (void)payload;
+    _acks++;
 }
 
 /**
-  * @brief  Sends the standard command termination sequence to Nextion (0xFF 0xFF 0xFF).
+  * @brief  Switches acknowledgment reporting for a benchmark on or off.
   *
-  *         According to the Nextion protocol, every command string sent to the
-  *         display must be terminated with three 0xFF bytes. This function handles
-  *         the transmission of that termination sequence via the assigned UART.
+  *         With "bkcmd=3" every instruction is acknowledged with 0x01, so the
+  *         arrival of the last acknowledgment marks the end of processing.
+  *         Switching off returns to the default "bkcmd=2".
+  *
+  * @param  enable: 1 before the measurement, 0 after it.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+static HAL_StatusTypeDef Track_Acks(uint8_t enable)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    if (enable && NEX_Rx_Register_Handler(NEX_RX_SUCCESS, Ack_Handler) != HAL_OK)
+        return HAL_ERROR;
+    if (Send_Mode_Command(enable ? NEX_BKCMD_ALWAYS : NEX_BKCMD_DEFAULT) != HAL_OK)
+        status = HAL_ERROR;
+    HAL_Delay(NEX_BAUD_SWITCH_DELAY_MS);   // Let the acknowledgment of bkcmd itself arrive
+    if (!enable)
+        NEX_Rx_Register_Handler(NEX_RX_SUCCESS, NULL);
+
+    return status;
+}
+
+/**
+  * @brief  Commits the open frame and waits for all of its acknowledgments.
+  * @param  timeout: Maximum wait in ms.
+  * @param  elapsed: Receives the time from commit to the last acknowledgment, in ms.
+  * @param  info:    Receives the size of the committed frame.
+  * @retval HAL_OK, HAL_TIMEOUT if acknowledgments were missing, HAL_ERROR if
+  *         the frame was not queued.
+  */
+static HAL_StatusTypeDef Commit_Timed(uint32_t timeout, uint32_t *elapsed, NEX_FrameInfo *info)
+{
+    _acks = 0;
+    uint32_t start = HAL_GetTick();
+
+    if (NEX_Frame_Commit() != HAL_OK)
+        return HAL_ERROR;
+    NEX_Frame_Get_Info(info);
+
+    while (_acks < info->commands && (HAL_GetTick() - start) < timeout)
+        NEX_Link_Service();
+
+    *elapsed = HAL_GetTick() - start;
+    return (_acks < info->commands) ? HAL_TIMEOUT : HAL_OK;
+}
+
+/**
+  * @brief  Measures how long the display takes to process an all-dirty frame.
   *
-  * @note   `_uart` must be initialized before calling this function.
-  *         Otherwise, the transmission will fail or crash the system.
+  *         The same all-dirty frame is sent once plain and once wrapped in
+  *         ref_stop / ref_star; the difference is the redraw time saved.
   *
-  * @retval None
+  * @param  result:  Destination of the measurement.
+  * @param  timeout: Maximum wait for the acknowledgments of one frame, in ms.
+  * @retval HAL_OK on success, HAL_TIMEOUT if acknowledgments were missing,
+  *         HAL_BUSY during a waveform transfer, HAL_ERROR if not bound or in binary mode.
   */
-static void Command_Terminator(void)
+HAL_StatusTypeDef NEX_Benchmark_Render(NEX_RenderBenchmark *result, uint32_t timeout)
 {
-    HAL_UART_Transmit(_uart, (uint8_t*)COMMAND_END, sizeof(COMMAND_END), 100);
+    HAL_StatusTypeDef status = HAL_OK;
+
+    if (result == NULL || _uart == NULL || _binaryMode)
+        return HAL_ERROR;
+    if (_waveWaiting)
+        return HAL_BUSY;
+
+    if (Track_Acks(1) != HAL_OK)
+        return HAL_ERROR;
+
+    for (uint8_t pass = 0; pass < 2 && status == HAL_OK; pass++) {
+        NEX_FrameInfo info;
+        uint32_t elapsed;
+
+        Mark_All_Dirty();
+        NEX_Frame_Begin();
+        if (pass == 1)
+            NEX_Frame_Wrap(NEX_REDRAW_STOP, NEX_REDRAW_START);
+        Send_Dirty_Widgets();
+
+        status = Commit_Timed(timeout, &elapsed, &info);
+
+        if (pass == 0) {
+            result->plainMs = elapsed;
+            result->plainBytes = info.size;
+            result->commands = info.commands;
+        } else {
+            result->atomicMs = elapsed;
+            result->atomicBytes = info.size;
+        }
+    }
+
+    if (Track_Acks(0) != HAL_OK)
+        status = HAL_ERROR;
+    return status;
+}
+
+/**
+  * @brief  Measures one map position update in both rendering modes.
+  *
+  *         The offsets step along the diagonal of the allowed pMap range, so
+  *         every update moves the map. Each update is one frame, wrapped in
+  *         ref_stop / ref_star when atomic frames are on, as NEX_Refresh()
+  *         would send it:
+  *           move: "pMap.x=<x>", "pMap.y=<y>"
+  *           crop: "xpic <window>,<x0>,<y0>,<picture>", NEX_MAP_OVERLAY
+  *         The HAL tick has 1 ms resolution, so the average becomes accurate
+  *         over many updates. Every widget is marked dirty afterwards, which
+  *         puts the map back in the configured mode.
+  *
+  * @param  result:  Destination of the measurement.
+  * @param  updates: Position updates per mode.
+  * @param  timeout: Maximum wait for the acknowledgments of one update, in ms.
+  * @retval HAL_OK on success, HAL_TIMEOUT if acknowledgments were missing,
+  *         HAL_BUSY during a waveform transfer, HAL_ERROR if not bound, in
+  *         binary mode or updates is 0.
+  */
+HAL_StatusTypeDef NEX_Benchmark_Map(NEX_MapBenchmark *result, uint16_t updates, uint32_t timeout)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+    uint32_t total[2] = {0, 0};
+
+    if (result == NULL || updates == 0 || _uart == NULL || _binaryMode)
+        return HAL_ERROR;
+    if (_waveWaiting)
+        return HAL_BUSY;
+
+    if (Track_Acks(1) != HAL_OK)
+        return HAL_ERROR;
+
+    for (uint8_t mode = 0; mode < 2 && status == HAL_OK; mode++) {
+        for (uint16_t i = 0; i < updates && status == HAL_OK; i++) {
+            int32_t x = MAP_X_MIN_VAL + (int32_t)(MAP_X_MAX_VAL - MAP_X_MIN_VAL) * i / updates;
+            int32_t y = MAP_Y_MAX_VAL - (int32_t)(MAP_Y_MAX_VAL - MAP_Y_MIN_VAL) * i / updates;
+            NEX_FrameInfo info;
+            uint32_t elapsed;
+
+            NEX_Frame_Begin();
+            if (_atomicFrames)
+                NEX_Frame_Wrap(NEX_REDRAW_STOP, NEX_REDRAW_START);
+
+            if (mode == 0) {
+                NEX_Frame_Append_Int(&NEX_MAP_X_COMMAND, x);
+                NEX_Frame_Append_Int(&NEX_MAP_Y_COMMAND, y);
+            } else {
+                int32_t args[3] = { NEX_MAP_VIEW_X - x, NEX_MAP_VIEW_Y - y, NEX_MAP_PICTURE };
+
+                NEX_Frame_Append_Ints(&NEX_MAP_CROP_COMMAND, args, 3);
+                NEX_Frame_Append(NEX_MAP_OVERLAY);
+            }
+
+            status = Commit_Timed(timeout, &elapsed, &info);
+            total[mode] += elapsed;
+            if (mode == 0)
+                result->moveBytes = info.size;
+            else
+                result->cropBytes = info.size;
+        }
+    }
+
+    result->moveUs = total[0] * 1000U / updates;
+    result->cropUs = total[1] * 1000U / updates;
+    result->updates = updates;
+
+    if (Track_Acks(0) != HAL_OK)
+        status = HAL_ERROR;
+    Mark_All_Dirty();
+    return status;
+}
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Copies the ASCII / binary wire size comparison.
+  *
+  *         asciiAllDirty is computed here from the current display values, so
+  *         it reflects the digits actually on screen.
+  *
+  * @param  stats: Destination structure.
+  * @retval None
+  */
+void NEX_Get_Wire_Stats(NEX_WireStats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    *stats = _wireStats;
+    stats->asciiAllDirty = 0;
+    for (uint8_t id = 0; id < _widgetCount; id++)
+        stats->asciiAllDirty += Widget_Size(&_widgets[id].config, _widgets[id].cached, _widgets[id].shown);
+    stats->binaryFrame = NEX_BINARY_OVERHEAD + 2U * _widgetCount;
+}
+
+/**
+  * @brief  Widget source for plain int values.
+  * @param  source: Address of an int.
+  * @retval Current value.
+  */
+int32_t NEX_Read_Int(const void *source)
+{
+    return *(const int *)source;
+}
+
+/**
+  * @brief  Widget source for NEX_State indicators.
+  * @param  source: Address of a NEX_State.
+  * @retval Current state (0 or 1).
+  */
+int32_t NEX_Read_State(const void *source)
+{
+    return *(const NEX_State *)source;
+}
+
+/**
+  * @brief  Widget source for the gear selector.
+  * @param  source: Address of a NEX_Gears.
+  * @retval Current gear.
+  */
+int32_t NEX_Read_Gear(const void *source)
+{
+    return *(const NEX_Gears *)source;
+}
+
+/**
+  * @brief  Widget source packing all indicators and the gear into one value.
+  * @param  source: Address of the NEX_Data structure.
+  * @retval vInd bitmask, see NEX_INDICATOR_* in dashboard_controls.h.
+  */
+int32_t NEX_Read_Indicators(const void *source)
+{
+    const NEX_Data *data = (const NEX_Data *)source;
+    int32_t mask = (int32_t)*data->gear << NEX_INDICATOR_GEAR_SHIFT;
+
+    if (*data->handbrake == NEX_STATE_ON)   mask |= NEX_INDICATOR_HANDBRAKE;
+    if (*data->signalLeft == NEX_STATE_ON)  mask |= NEX_INDICATOR_SIGNAL_L;
+    if (*data->signalRight == NEX_STATE_ON) mask |= NEX_INDICATOR_SIGNAL_R;
+    if (*data->connWarn == NEX_STATE_ON)    mask |= NEX_INDICATOR_CONN_WARN;
+    if (*data->battWarn == NEX_STATE_ON)    mask |= NEX_INDICATOR_BATT_WARN;
+    if (*data->lights == NEX_STATE_ON)      mask |= NEX_INDICATOR_LIGHTS;
+
+    return mask;
+}
+
+/**
+  * @brief  Widget source of the cropped map window.
+  *
+  *         x0 / y0 is the map pixel shown at the window's top-left corner:
+  *         the window position minus the screen position of map pixel 0,0
+  *         (PixelX / PixelY, the same offset pMap.x / pMap.y would get).
+  *
+  * @param  source: Address of the MapOffset structure.
+  * @retval x0 << 16 | y0, both as 16-bit fields.
+  */
+int32_t NEX_Read_Map_Crop(const void *source)
+{
+    const MapOffset *map = (const MapOffset *)source;
+    uint16_t x0 = (uint16_t)(NEX_MAP_VIEW_X - map->PixelX);
+    uint16_t y0 = (uint16_t)(NEX_MAP_VIEW_Y - map->PixelY);
+
+    return (int32_t)(((uint32_t)x0 << 16) | y0);
+}
+
+/**
+  * @brief  Widget source for free-form text.
+  *
+  *         Returns the 32-bit FNV-1a hash of the first NEX_TEXT_MAX_LENGTH
+  *         characters, so the cache compares one word instead of the string.
+  *
+  * @param  source: Null-terminated char buffer.
+  * @retval Hash of the current text.
+  */
+int32_t NEX_Read_Text(const void *source)
+{
+    const char *text = (const char *)source;
+    uint32_t hash = 2166136261UL;
+
+    for (uint16_t i = 0; i < NEX_TEXT_MAX_LENGTH && text[i] != '\0'; i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619UL;
+    }
+    return (int32_t)hash;
+}
+
+/**
+  * @brief  Encoder sending the value unchanged, e.g. "nSd.val=42".
+  * @param  widget:  Widget configuration.
+  * @param  value:   Value to send.
+  * @param  display: Receives value.
+  * @retval HAL_OK
+  */
+HAL_StatusTypeDef NEX_Encode_Number(const NEX_WidgetConfig *widget, int32_t value, int32_t *display)
+{
+    (void)widget;
+    *display = value;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Encoder mapping inMin..inMax linearly onto outMin..outMax.
+  *
+  *         Used for progress bars: a 0-100 bar is outMin = 0, outMax = 100, a
+  *         reversed bar simply swaps them (outMin = 100, outMax = 0).
+  *
+  * @param  widget:  Widget configuration holding the scaling ranges.
+  * @param  value:   Value to scale.
+  * @param  display: Receives the scaled value.
+  * @retval HAL_OK on success, HAL_ERROR if the value is outside inMin..inMax.
+  *
+  * @note   Uses Map_Int() to scale the input value.
+  */
+HAL_StatusTypeDef NEX_Encode_Scaled(const NEX_WidgetConfig *widget, int32_t value, int32_t *display)
+{
+    if (value < widget->inMin || value > widget->inMax)
+        return HAL_ERROR;  // Value out of range
+
+    *display = Map_Int(value, widget->inMin, widget->inMax, widget->outMin, widget->outMax);
+    return HAL_OK;
+}
+
+/**
+  * @brief  Encoder translating a small enumerated value through a table,
+  *         e.g. a gear to its picture ID or a state to an icon alpha.
+  * @param  widget:  Widget configuration holding the lookup table.
+  * @param  value:   Index into the lookup table.
+  * @param  display: Receives lookup[value].
+  * @retval HAL_OK on success, HAL_ERROR if the index is invalid.
+  */
+HAL_StatusTypeDef NEX_Encode_Lookup(const NEX_WidgetConfig *widget, int32_t value, int32_t *display)
+{
+    if (widget->lookup == NULL || value < 0 || value >= widget->lookupSize)
+        return HAL_ERROR;
+
+    *display = widget->lookup[value];
+    return HAL_OK;
+}
+
+/**
+  * @brief  Encoder for text widgets.
+  *
+  *         With a string table the value is the intern ID and is range
+  *         checked; it is also the display value packed into binary frames.
+  *         Free-form text has no numeric form and is packed as 0.
+  *
+  * @param  widget:  Widget configuration.
+  * @param  value:   Intern ID or text hash.
+  * @param  display: Receives the intern ID or 0.
+  * @retval HAL_OK on success, HAL_ERROR if the intern ID is invalid.
+  */
+HAL_StatusTypeDef NEX_Encode_Text(const NEX_WidgetConfig *widget, int32_t value, int32_t *display)
+{
+    if (widget->strings == NULL) {
+        *display = 0;
+        return HAL_OK;
+    }
+    if (value < 0 || value >= widget->stringCount)
+        return HAL_ERROR;
+
+    *display = value;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Registers the widgets of the standard dashboard page from NEX_Data.
+  *
+  *         Adding a widget to the page only requires one entry here (or one
+  *         NEX_Register_Widget() call from the application).
+  *
+  * @param  data: Runtime data bindings.
+  * @retval HAL_OK if every widget was registered, HAL_ERROR otherwise.
+  */
+static HAL_StatusTypeDef Register_Standard_Widgets(NEX_Data *data)
+{
+    if (data->mapData == NULL)
+        return HAL_ERROR;
+
+#define NUMBER(cmd, src, prio) \
+    { .prefix = NEX_PREFIX(cmd), .read = NEX_Read_Int, .source = (src), .encode = NEX_Encode_Number, \
+      .priority = (prio) }
+#define FILTERED(cmd, src, band, intervalMs, prio) \
+    { .prefix = NEX_PREFIX(cmd), .read = NEX_Read_Int, .source = (src), .encode = NEX_Encode_Number, \
+      .deadband = (band), .minIntervalMs = (intervalMs), .priority = (prio) }
+#define BAR(cmd, src, lo, hi, outLo, outHi, prio) \
+    { .prefix = NEX_PREFIX(cmd), .read = NEX_Read_Int, .source = (src), .encode = NEX_Encode_Scaled, \
+      .inMin = (lo), .inMax = (hi), .outMin = (outLo), .outMax = (outHi), .priority = (prio) }
+#define INDICATOR(cmd, src, prio) \
+    { .prefix = NEX_PREFIX(cmd), .read = NEX_Read_State, .source = (src), .encode = NEX_Encode_Lookup, \
+      .lookup = NEX_Indicator_Alpha, .lookupSize = sizeof(NEX_Indicator_Alpha) / sizeof(NEX_Indicator_Alpha[0]), \
+      .priority = (prio) }
+
+    const NEX_WidgetConfig standard[] = {
+        /* Speed Display */
+        FILTERED("nSd.val=", data->speed, 1, 100, NEX_PRIORITY_HIGH),           // Speed number (km/h), ±1 jitter
+
+        /* Battery Display */
+        NUMBER("nBt.val=", data->batteryValue, NEX_PRIORITY_NORMAL),            // Battery value (number)
+        BAR("jBt.val=", data->batteryValue,                                     // Battery progress bar (percentage)
+            NEX_BATTERY_PROGRESS_BAR_MIN_VAL, NEX_BATTERY_PROGRESS_BAR_MAX_VAL, 0, 100, NEX_PRIORITY_NORMAL),
+
+        /* Power Display */
+        NUMBER("nKW.val=", data->powerKW, NEX_PRIORITY_HIGH),                   // Power in kW
+        BAR("jKW.val=", data->powerKW,                                          // Power progress bar (reversed)
+            NEX_KW_PROGRESS_BAR_MIN_VAL, NEX_KW_PROGRESS_BAR_MAX_VAL, 100, 0, NEX_PRIORITY_HIGH),
+
+        /* Voltage Display */
+        FILTERED("xBV.val=", data->packVoltage, 1, 250, NEX_PRIORITY_LOW),      // Total battery voltage
+        FILTERED("xBMa.val=", data->maxVoltage, 1, 500, NEX_PRIORITY_LOW),      // Maximum battery voltage
+        FILTERED("xBMi.val=", data->minVoltage, 1, 500, NEX_PRIORITY_LOW),      // Minimum battery voltage
+
+        /* Battery Temperature */
+        FILTERED("xBtT.val=", data->batteryTemp, 5, 1000, NEX_PRIORITY_LOW),    // Battery temperature (0.01 °C)
+
+        /* Map Controls */
+#if NEX_MAP_CROP
+        { .prefix = NEX_PREFIX(NEX_MAP_CROP_PREFIX), .read = NEX_Read_Map_Crop, .source = data->mapData,
+          .encode = NEX_Encode_Number, .format = NEX_FORMAT_CROP, .picture = NEX_MAP_PICTURE,
+          .overlay = NEX_MAP_OVERLAY, .priority = NEX_PRIORITY_NORMAL },       // Map window
+#else
+        NUMBER("pMap.x=", &data->mapData->PixelX, NEX_PRIORITY_NORMAL),         // Map X coordinate
+        NUMBER("pMap.y=", &data->mapData->PixelY, NEX_PRIORITY_NORMAL),         // Map Y coordinate
+#endif
+        NUMBER("zIc.val=", &data->mapData->IconAngle, NEX_PRIORITY_NORMAL),     // Icon direction
+        NUMBER("nLap.val=", &data->mapData->Lap, NEX_PRIORITY_NORMAL),          // Lap counter
+
+#if NEX_PACK_INDICATORS
+        /* Indicators and Gear, one bitmask */
+        { .prefix = NEX_PREFIX("vInd.val="), .read = NEX_Read_Indicators, .source = data,
+          .encode = NEX_Encode_Number, .priority = NEX_PRIORITY_CRITICAL },
+#else
+        /* Gear Display */
+        { .prefix = NEX_PREFIX("pGr.pic="), .read = NEX_Read_Gear, .source = data->gear,
+          .encode = NEX_Encode_Lookup, .lookup = NEX_Gear_Pictures,
+          .lookupSize = sizeof(NEX_Gear_Pictures) / sizeof(NEX_Gear_Pictures[0]),
+          .priority = NEX_PRIORITY_CRITICAL },
+
+        /* Indicators */
+        INDICATOR("pHb.aph=", data->handbrake, NEX_PRIORITY_CRITICAL),          // Handbrake
+#if NEX_DISPLAY_BLINK
+        { .prefix = NEX_PREFIX("vSL.val="), .read = NEX_Read_State, .source = data->signalLeft,
+          .encode = NEX_Encode_Number, .priority = NEX_PRIORITY_CRITICAL },     // Left signal switch
+        { .prefix = NEX_PREFIX("vSR.val="), .read = NEX_Read_State, .source = data->signalRight,
+          .encode = NEX_Encode_Number, .priority = NEX_PRIORITY_CRITICAL },     // Right signal switch
+#else
+        INDICATOR("pSL.aph=", data->signalLeft, NEX_PRIORITY_CRITICAL),         // Left signal
+        INDICATOR("pSR.aph=", data->signalRight, NEX_PRIORITY_CRITICAL),        // Right signal
+#endif
+        INDICATOR("pCW.aph=", data->connWarn, NEX_PRIORITY_CRITICAL),           // Connection warning
+        INDICATOR("pBW.aph=", data->battWarn, NEX_PRIORITY_CRITICAL),           // Battery warning
+        INDICATOR("pLt.aph=", data->lights, NEX_PRIORITY_HIGH),                 // Lights
+#endif
+
+#if NEX_DISPLAY_BLINK
+        /* Turn signal blink timer on the display */
+        NUMBER("tmBlk.tim=", &NEX_Blink_Period, NEX_PRIORITY_LOW),
+#endif
+    };
+
+#undef NUMBER
+#undef FILTERED
+#undef BAR
+#undef INDICATOR
+
+    for (uint32_t i = 0; i < sizeof(standard) / sizeof(standard[0]); i++) {
+        uint8_t *id = (standard[i].format == NEX_FORMAT_CROP) ? &_mapWidget : NULL;
+
+        if (NEX_Register_Widget(&standard[i], id) != HAL_OK)
+            return HAL_ERROR;
+    }
+
+#if NEX_HISTORY_GRAPH
+    /* Speed and power history, one minute on channels 0 and 1 */
+    const NEX_WaveformConfig history[] = {
+        { .objectId = NEX_HISTORY_GRAPH_ID, .channel = 0, .page = NEX_HISTORY_GRAPH_PAGE,
+          .height = NEX_HISTORY_GRAPH_HEIGHT, .read = NEX_Read_Int, .source = data->speed,
+          .inMin = 0, .inMax = NEX_HISTORY_SPEED_MAX,
+          .sampleMs = NEX_HISTORY_SAMPLE_MS, .flushMs = NEX_HISTORY_FLUSH_MS },
+        { .objectId = NEX_HISTORY_GRAPH_ID, .channel = 1, .page = NEX_HISTORY_GRAPH_PAGE,
+          .height = NEX_HISTORY_GRAPH_HEIGHT, .read = NEX_Read_Int, .source = data->powerKW,
+          .inMin = NEX_KW_PROGRESS_BAR_MIN_VAL, .inMax = NEX_KW_PROGRESS_BAR_MAX_VAL,
+          .sampleMs = NEX_HISTORY_SAMPLE_MS, .flushMs = NEX_HISTORY_FLUSH_MS },
+    };
+
+    for (uint32_t i = 0; i < sizeof(history) / sizeof(history[0]); i++) {
+        if (NEX_Register_Waveform(&history[i]) != HAL_OK)
+            return HAL_ERROR;
+    }
+#endif
+    return HAL_OK;
+}
+
+/**
+  * @brief  Reads every widget source and sets the dirty bit of changed widgets.
+  * @note   One load and compare per unchanged widget; nothing is encoded here.
+  * @retval None
+  */
+static void Scan_Widgets(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t id = 0; id < _widgetCount; id++) {
+        NEX_Widget *widget = &_widgets[id];
+        int32_t value = widget->config.read(widget->config.source);
+        uint8_t changed = (value != widget->lastSeen);
+
+        if (changed) {
+            widget->lastSeen = value;
+            widget->lastChangeTick = now;
+            widget->rejected = 0;
+        }
+
+        if (_dirty[widget->config.priority][id / 32U] & (1UL << (id % 32U))) {
+            if (changed)
+                widget->stats.coalesced++;  // Pending entry now carries the newer value
+            continue;
+        }
+
+        if (value == widget->cached || widget->rejected)
+            continue;   // Nothing new, or not displayable until it changes
+
+        if (Filter_Allows(widget, value, now))
+            Set_Dirty(id, now);
+        else
+            widget->stats.suppressed++;
+    }
+}
+
+/**
+  * @brief  Decides whether a changed value passes the widget's deadband and rate limit.
+  *
+  *         A value is sent when it leaves the deadband around the displayed value
+  *         and the minimum interval has elapsed, or unconditionally once it has
+  *         been stable for settleMs, so small steady offsets are never hidden.
+  *
+  * @param  widget: Widget whose source value differs from the cached value.
+  * @param  value:  Current source value.
+  * @param  now:    Current HAL tick in ms.
+  * @retval 1 if the widget should be sent, 0 to hold it back.
+  */
+static uint8_t Filter_Allows(NEX_Widget *widget, int32_t value, uint32_t now)
+{
+    const NEX_WidgetConfig *config = &widget->config;
+    uint32_t delta = (value > widget->cached) ? (uint32_t)value - (uint32_t)widget->cached
+                                              : (uint32_t)widget->cached - (uint32_t)value;
+
+    if (delta > config->deadband && now - widget->lastSendTick >= config->minIntervalMs)
+        return 1;
+
+    return (now - widget->lastChangeTick >= config->settleMs) ? 1 : 0;
+}
+
+/**
+  * @brief  Appends the dirty widgets to the open frame, CRITICAL class first.
+  *
+  *         Widgets that do not fit stay dirty; the deferral is counted once
+  *         per priority class. Widgets whose value the encoder rejects are
+  *         dropped (see Reject_Widget()) and not counted as deferred.
+  *
+  * @retval HAL_OK if every dirty widget was appended, HAL_BUSY if some were
+  *         deferred by the byte budget, HAL_ERROR if a value was rejected or
+  *         the frame could not be extended.
+  */
+static HAL_StatusTypeDef Send_Dirty_Widgets(void)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    for (uint32_t order = 0; order < NEX_PRIORITY_COUNT; order++) {
+        NEX_Priority priority = NEX_Priority_Order[order];
+        uint8_t deferred = 0;
+
+        for (uint32_t word = 0; word < NEX_WIDGET_WORDS; word++) {
+            uint32_t bits = _dirty[priority][word] & _visible[word];   // Hidden pages wait
+
+            while (bits != 0) {
+                uint32_t bit = __CLZ(__RBIT(bits));   // index of the lowest set bit
+                bits &= bits - 1U;
+
+                HAL_StatusTypeDef result = Send_Widget((uint8_t)(word * 32U + bit));
+                if (result == HAL_BUSY)
+                    deferred = 1;
+                else if (result != HAL_OK)
+                    status = HAL_ERROR;
+            }
+        }
+
+        if (deferred) {
+            _priorityStats[priority].deferred++;
+            if (status == HAL_OK)
+                status = HAL_BUSY;  // Retried next frame; a reject still wins
+        }
+    }
+    return status;
+}
+
+/**
+  * @brief  Encodes the latest value of a dirty widget into the open frame.
+  *
+  *         On success the value is cached and the dirty bit is cleared. A
+  *         command that does not fit leaves the widget dirty, so it is retried
+  *         on the next refresh. A value the encoder rejects is dropped.
+  *
+  * @param  id: Widget index.
+  * @retval HAL_OK if appended, HAL_BUSY if the frame is full,
+  *         HAL_ERROR if the value is not displayable.
+  */
+static HAL_StatusTypeDef Send_Widget(uint8_t id)
+{
+    NEX_Widget *widget = &_widgets[id];
+    int32_t value = widget->config.read(widget->config.source);
+    int32_t display;
+
+    if (widget->config.encode(&widget->config, value, &display) != HAL_OK) {
+        Reject_Widget(id);
+        return HAL_ERROR;
+    }
+    if (Append_Widget(&widget->config, value, display) != HAL_OK)
+        return HAL_BUSY;
+
+    Mark_Sent(id, value, display, HAL_GetTick());
+    return HAL_OK;
+}
+
+/**
+  * @brief  Re-sends the displayed value of a few widgets with the leftover budget.
+  *
+  *         The quota per frame is the widget count times the refresh period
+  *         divided by the resync period, rounded up, so one pass over all
+  *         widgets takes at most the resync period. It runs before the trail
+  *         (see Send_Trail()) so the bound holds while the trail is redrawn.
+  *         Hidden and dirty widgets are passed over (a dirty one is about to
+  *         be sent anyway), and so are widgets just sent in this frame. The
+  *         sweep stops at the first command that does not fit and resumes
+  *         there.
+  *
+  * @retval None
+  */
+static void Resync_Widgets(void)
+{
+    if (_resyncPeriodMs == 0 || _widgetCount == 0)
+        return;
+
+    uint32_t quota = (_widgetCount * _refreshPeriodMs + _resyncPeriodMs - 1U) / _resyncPeriodMs;
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t visited = 0; visited < _widgetCount && quota > 0; visited++) {
+        uint8_t id = _resyncCursor;
+        NEX_Widget *widget = &_widgets[id];
+        uint32_t mask = 1UL << (id % 32U);
+
+        if ((_visible[id / 32U] & mask) && !(_dirty[widget->config.priority][id / 32U] & mask) &&
+            widget->lastSendTick != now &&
+            (widget->config.format != NEX_FORMAT_TEXT || widget->config.strings != NULL ||
+             widget->config.read(widget->config.source) == widget->cached)) {  // Sent text still in the buffer
+            if (Append_Widget(&widget->config, widget->cached, widget->shown) != HAL_OK)
+                return;     // Budget used up, retry this widget next frame
+            widget->stats.resynced++;
+            quota--;
+        }
+
+        _resyncCursor = (uint8_t)((id + 1U) % _widgetCount);
+    }
+}
+
+/**
+  * @brief  Draws the trail segments that are missing on the display.
+  *
+  *         A new lap erases the old trail first. A full pass (every segment,
+  *         newest first) starts after a page load or when the map has moved
+  *         and the last full pass is NEX_TRAIL_REDRAW_MS old; otherwise only
+  *         segments added since the last refresh and the moved tip segment are
+  *         drawn. Segments use the budget left after the resync sweep: the
+  *         pass stops at the first one that does not fit and resumes there on
+  *         the next refresh.
+  *
+  * @note   Called only when every dirty widget fit into the frame, so the
+  *         map offset on the display equals mapData.
+  * @retval None
+  */
+static void Send_Trail(void)
+{
+    const MapOffset *map = _dashboard->mapData;
+    uint32_t now = HAL_GetTick();
+    uint8_t count = Map_Trail_Get_Count();
+    Map_Trail_Stats stats;
+
+    if (map->Lap != _trailLap) {
+        _trailLap = map->Lap;       // Trail restarted with the lap (Map_Trail_Reset())
+        _trailErase = _trailEnabled;
+        _trailVertices = _trailChanges = 0;
+        _trailNext = _trailStop = 0;
+    }
+
+    if (_trailErase) {
+#if NEX_MAP_CROP
+        NEX_Widget *window = &_widgets[_mapWidget];
+
+        if (Append_Widget(&window->config, window->cached, window->shown) != HAL_OK)
+            return;                 // Copy the window again over the lines
+#else
+        if (NEX_Frame_Append(NEX_TRAIL_ERASE) != HAL_OK)
+            return;
+#endif
+        _trailErase = 0;
+    }
+
+    if (!_trailEnabled)
+        return;
+
+    Map_Trail_Get_Stats(&stats);
+    int32_t first = (int32_t)(stats.vertices - count);     // Sequence number of vertex 0
+
+    if (_trailRedraw || ((map->PixelX != _trailOffsetX || map->PixelY != _trailOffsetY) &&
+                         now - _trailTick >= NEX_TRAIL_REDRAW_MS)) {
+        _trailRedraw = 0;           // Picture repainted: the whole trail is gone
+        _trailOffsetX = map->PixelX;
+        _trailOffsetY = map->PixelY;
+        _trailTick = now;
+        _trailNext = (int32_t)stats.vertices - 1;
+        _trailStop = first + 1;
+    } else if (stats.vertices + stats.merged != _trailChanges) {
+        int32_t oldest = (_trailVertices > 0) ? (int32_t)_trailVertices - 1 : 0;  // Tip may have moved
+
+        if (_trailNext < _trailStop || oldest < _trailStop)
+            _trailStop = oldest;
+        _trailNext = (int32_t)stats.vertices - 1;
+    }
+
+    _trailVertices = stats.vertices;
+    _trailChanges = stats.vertices + stats.merged;
+
+    for (; _trailNext >= _trailStop; _trailNext--) {
+        int32_t index = _trailNext - first;
+
+        if (index < 1)
+            break;                  // Older vertices dropped out of the ring
+
+        Map_Trail_Point from = Map_Trail_Get_Point((uint8_t)(index - 1));
+        Map_Trail_Point to = Map_Trail_Get_Point((uint8_t)index);
+        int32_t line[5] = {
+            from.x + map->PixelX, from.y + map->PixelY,
+            to.x + map->PixelX, to.y + map->PixelY,
+            NEX_TRAIL_COLOR
+        };
+
+        if (Clip_Segment(line) && NEX_Frame_Append_Ints(&NEX_LINE_COMMAND, line, 5) != HAL_OK)
+            return;                 // Budget used up, resume with this segment
+    }
+
+    _trailNext = _trailStop - 1;    // Pass complete
+}
+
+/**
+  * @brief  Clips a segment to the map window (Cohen-Sutherland, integer).
+  *
+  *         Lines are drawn straight into the screen buffer, so a segment
+  *         reaching past the window would paint over neighbouring widgets
+  *         that no map repaint erases.
+  *
+  * @param  line: x1, y1, x2, y2 in screen pixels, clipped in place.
+  * @retval 1 if a part of the segment is inside the window, 0 otherwise.
+  */
+static uint8_t Clip_Segment(int32_t *line)
+{
+    const int32_t xMin = NEX_MAP_VIEW_X, xMax = NEX_MAP_VIEW_X + NEX_MAP_VIEW_W - 1;
+    const int32_t yMin = NEX_MAP_VIEW_Y, yMax = NEX_MAP_VIEW_Y + NEX_MAP_VIEW_H - 1;
+
+    for (uint8_t pass = 0; pass < 8U; pass++) {
+        uint8_t codes[2];
+
+        for (uint8_t i = 0; i < 2U; i++) {
+            int32_t x = line[2U * i], y = line[2U * i + 1U];
+            codes[i] = (uint8_t)(((x < xMin) ? 1U : 0U) | ((x > xMax) ? 2U : 0U) |
+                                 ((y < yMin) ? 4U : 0U) | ((y > yMax) ? 8U : 0U));
+        }
+
+        if ((codes[0] | codes[1]) == 0U)
+            return 1;               // Inside
+        if ((codes[0] & codes[1]) != 0U)
+            return 0;               // Entirely on one outer side
+
+        uint8_t end = (codes[0] != 0U) ? 0U : 1U;
+        uint8_t code = codes[end];
+        int32_t dx = line[2] - line[0], dy = line[3] - line[1];
+        int32_t x, y;
+
+        if (code & 4U)      { y = yMin; x = line[0] + dx * (y - line[1]) / dy; }
+        else if (code & 8U) { y = yMax; x = line[0] + dx * (y - line[1]) / dy; }
+        else if (code & 1U) { x = xMin; y = line[1] + dy * (x - line[0]) / dx; }
+        else                { x = xMax; y = line[1] + dy * (x - line[0]) / dx; }
+
+        line[2U * end] = x;
+        line[2U * end + 1U] = y;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  Appends the command of a widget in its format.
+  * @param  config:  Widget configuration.
+  * @param  value:   Source value (intern ID for text).
+  * @param  display: Converted display value (numbers).
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+static HAL_StatusTypeDef Append_Widget(const NEX_WidgetConfig *config, int32_t value, int32_t display)
+{
+    if (config->format == NEX_FORMAT_TEXT)
+        return NEX_Frame_Append_Text(&config->prefix, Widget_Text(config, value));
+
+    if (config->format == NEX_FORMAT_CROP) {
+        int32_t args[3];
+
+        if (Widget_Size(config, value, display) > NEX_Frame_Get_Free())
+            return HAL_ERROR;       // The window and its overlay go out together or not at all
+
+        Crop_Arguments(config, display, args);
+        if (NEX_Frame_Append_Ints(&config->prefix, args, 3) != HAL_OK ||
+            (config->overlay != NULL && NEX_Frame_Append(config->overlay) != HAL_OK))
+            return HAL_ERROR;
+        return HAL_OK;
+    }
+
+    return NEX_Frame_Append_Int(&config->prefix, display);
+}
+
+/**
+  * @brief  Returns the ASCII command size of a widget, for the wire statistics.
+  * @param  config:  Widget configuration.
+  * @param  value:   Source value (intern ID for text).
+  * @param  display: Converted display value (numbers).
+  * @retval Command size in bytes, terminator included.
+  */
+static uint16_t Widget_Size(const NEX_WidgetConfig *config, int32_t value, int32_t display)
+{
+    if (config->format == NEX_FORMAT_TEXT)
+        return NEX_Frame_Text_Size(&config->prefix, Widget_Text(config, value));
+
+    if (config->format == NEX_FORMAT_CROP) {
+        int32_t args[3];
+
+        Crop_Arguments(config, display, args);
+        return NEX_Frame_Ints_Size(&config->prefix, args, 3) +
+               ((config->overlay != NULL) ? strlen(config->overlay) + NEX_COMMAND_END_SIZE : 0U);
+    }
+
+    return NEX_Frame_Int_Size(&config->prefix, display);
+}
+
+/**
+  * @brief  Unpacks the xpic arguments of a crop widget.
+  * @param  config:  Widget configuration.
+  * @param  display: Packed offset, x0 << 16 | y0.
+  * @param  args:    Receives x0, y0 and the picture ID.
+  * @retval None
+  */
+static void Crop_Arguments(const NEX_WidgetConfig *config, int32_t display, int32_t *args)
+{
+    args[0] = (int16_t)((uint32_t)display >> 16);
+    args[1] = (int16_t)((uint32_t)display & 0xFFFFU);
+    args[2] = config->picture;
+}
+
+/**
+  * @brief  Resolves the text of a text widget.
+  * @param  config: Widget configuration.
+  * @param  value:  Intern ID when the widget has a string table.
+  * @retval Interned string, the source buffer, or "" for an invalid ID.
+  */
+static const char *Widget_Text(const NEX_WidgetConfig *config, int32_t value)
+{
+    if (config->strings == NULL)
+        return (const char *)config->source;
+    if (value < 0 || value >= config->stringCount || config->strings[value] == NULL)
+        return "";
+
+    return config->strings[value];
+}
+
+/**
+  * @brief  Records that a widget value went into the open frame.
+  *
+  *         Caches the value, clears the dirty and restore bits and updates the
+  *         widget and priority class counters.
+  *
+  * @param  id:      Widget index.
+  * @param  value:   Source value sent.
+  * @param  display: Display value sent.
+  * @param  now:     Current HAL tick.
+  * @retval None
+  */
+static void Mark_Sent(uint8_t id, int32_t value, int32_t display, uint32_t now)
+{
+    NEX_Widget *widget = &_widgets[id];
+    NEX_PriorityStats *classStats = &_priorityStats[widget->config.priority];
+
+    widget->cached = value;
+    widget->shown = display;
+    widget->lastSendTick = now;
+    widget->stats.sent++;
+    _dirty[widget->config.priority][id / 32U] &= ~(1UL << (id % 32U));
+    _restorePending[id / 32U] &= ~(1UL << (id % 32U));
+
+    classStats->sent++;
+    classStats->lastLatencyMs = now - widget->dirtyTick;
+    if (classStats->lastLatencyMs > classStats->worstLatencyMs)
+        classStats->worstLatencyMs = classStats->lastLatencyMs;
+}
+
+/**
+  * @brief  Drops a widget update whose value the encoder rejected.
+  *
+  *         Clears the dirty and restore bits, so the value is neither retried
+  *         every refresh nor holds up a replay. The display keeps its previous
+  *         value until the source changes (see Scan_Widgets()).
+  *
+  * @param  id: Widget index.
+  * @retval None
+  */
+static void Reject_Widget(uint8_t id)
+{
+    NEX_Widget *widget = &_widgets[id];
+
+    widget->rejected = 1;
+    widget->stats.encodeErrors++;
+    _dirty[widget->config.priority][id / 32U] &= ~(1UL << (id % 32U));
+    _restorePending[id / 32U] &= ~(1UL << (id % 32U));
+}
+
+/**
+  * @brief  Builds the fixed-layout binary frame of all widgets into the open frame.
+  *
+  *         Nothing is sent while no widget is dirty. Otherwise every widget's
+  *         current display value is packed in registry order; a widget whose
+  *         value the encoder rejects keeps its previous display value and is
+  *         dropped like in the ASCII path (see Reject_Widget()). The new
+  *         display values are only taken over once the frame fits. The ASCII
+  *         size of the same update (dirty widgets only) is accounted for the
+  *         wire size comparison.
+  *
+  * @retval HAL_OK if appended or nothing to send, HAL_BUSY if it did not fit
+  *         the byte budget, HAL_ERROR if a value was rejected.
+  */
+static HAL_StatusTypeDef Send_Binary_Frame(void)
+{
+    static uint8_t frame[NEX_BINARY_OVERHEAD + 2U * NEX_MAX_WIDGETS];
+    int32_t values[NEX_MAX_WIDGETS];
+    int32_t displays[NEX_MAX_WIDGETS];
+    uint32_t rejected[NEX_WIDGET_WORDS] = {0};
+    HAL_StatusTypeDef status = HAL_OK;
+    uint16_t length = 0;
+    uint16_t asciiSize = 0;
+    uint8_t checksum;
+
+    if (!Any_Dirty())
+        return HAL_OK;
+
+    frame[length++] = NEX_BINARY_HEADER_0;
+    frame[length++] = NEX_BINARY_HEADER_1;
+    frame[length++] = _widgetCount;
+    checksum = _widgetCount;
+
+    for (uint8_t id = 0; id < _widgetCount; id++) {
+        NEX_Widget *widget = &_widgets[id];
+        uint32_t dirty = _dirty[widget->config.priority][id / 32U] & _visible[id / 32U] & (1UL << (id % 32U));
+
+        values[id] = widget->config.read(widget->config.source);
+        if (widget->config.encode(&widget->config, values[id], &displays[id]) != HAL_OK) {
+            displays[id] = widget->shown;
+            rejected[id / 32U] |= 1UL << (id % 32U);
+        } else if (dirty) {
+            asciiSize += Widget_Size(&widget->config, values[id], displays[id]);
+        }
+
+        int16_t packed = (displays[id] > INT16_MAX) ? INT16_MAX
+                       : (displays[id] < INT16_MIN) ? INT16_MIN : (int16_t)displays[id];
+        frame[length++] = (uint8_t)((uint16_t)packed & 0xFFU);
+        frame[length++] = (uint8_t)((uint16_t)packed >> 8);
+        checksum += frame[length - 2] + frame[length - 1];
+    }
+    frame[length++] = checksum;
+
+    if (NEX_Frame_Append_Bytes(frame, length) != HAL_OK)
+        return HAL_BUSY;    // Widgets stay dirty for the next frame
+
+    uint32_t now = HAL_GetTick();
+    for (uint8_t id = 0; id < _widgetCount; id++) {
+        NEX_Widget *widget = &_widgets[id];
+        uint32_t mask = 1UL << (id % 32U);
+
+        if (rejected[id / 32U] & mask) {
+            if (_dirty[widget->config.priority][id / 32U] & _visible[id / 32U] & mask) {
+                Reject_Widget(id);
+                status = HAL_ERROR;
+            }
+        } else if (_dirty[widget->config.priority][id / 32U] & _visible[id / 32U] & mask) {
+            Mark_Sent(id, values[id], displays[id], now);
+        } else {
+            widget->cached = values[id];    // Sent as well, even if held back by its filter
+            widget->shown = displays[id];
+        }
+    }
+
+    _wireStats.frames++;
+    _wireStats.asciiBytes += asciiSize;
+    _wireStats.binaryBytes += length;
+    return status;
+}
+
+/**
+  * @brief  Checks whether any widget of any priority class is dirty.
+  * @retval 1 if at least one dirty bit is set, 0 otherwise.
+  */
+static uint8_t Any_Dirty(void)
+{
+    for (uint32_t priority = 0; priority < NEX_PRIORITY_COUNT; priority++) {
+        for (uint32_t word = 0; word < NEX_WIDGET_WORDS; word++) {
+            if ((_dirty[priority][word] & _visible[word]) != 0)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * @brief  Sends one mode-switch command on an otherwise idle link.
+  * @param  command: Command string.
+  * @retval HAL_OK if the command left the TX queue, HAL_ERROR otherwise.
+  */
+static HAL_StatusTypeDef Send_Mode_Command(const char *command)
+{
+    if (NEX_Link_Flush(NEX_BAUD_SWITCH_DELAY_MS) != HAL_OK)
+        return HAL_ERROR;
+
+    NEX_Frame_Begin();
+    if (NEX_Frame_Append(command) != HAL_OK || NEX_Frame_Commit() != HAL_OK)
+        return HAL_ERROR;
+
+    return NEX_Link_Flush(NEX_BAUD_SWITCH_DELAY_MS);
+}
+
+/**
+  * @brief  Checks whether the UART can generate a baud rate accurately enough.
+  *
+  *         The divider is computed the way HAL_UART_Init() programs it
+  *         (16x oversampling, 4-bit fraction) and the resulting rate is
+  *         compared with the requested one.
+  *
+  * @param  baudRate: Requested baud rate.
+  * @retval 1 if the error is within NEX_BAUD_MAX_ERROR_PERMILLE, 0 otherwise.
+  */
+static uint8_t Baud_Is_Reachable(uint32_t baudRate)
+{
+    uint32_t pclk = (_uart->Instance == USART1 || _uart->Instance == USART6)
+                    ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+    uint32_t brr = UART_BRR_SAMPLING16(pclk, baudRate);
+
+    if (brr < 16U)
+        return 0;   // Divider below 1.0 is not allowed
+
+    uint32_t actual = pclk / brr;   // baud = fPCLK / (16 * USARTDIV), USARTDIV = BRR / 16
+    uint32_t error = (actual > baudRate) ? actual - baudRate : baudRate - actual;
+
+    return ((uint64_t)error * 1000U <= (uint64_t)baudRate * NEX_BAUD_MAX_ERROR_PERMILLE) ? 1 : 0;
+}
+
+/**
+  * @brief  Sends "baud=<rate>" and moves the UART to that rate.
+  * @param  baudRate: New baud rate.
+  * @retval HAL_OK if the UART was re-initialized, HAL_ERROR otherwise.
+  * @note   The TX queue is drained before and after the command, so no byte
+  *         is ever sent at the wrong rate.
+  */
+static HAL_StatusTypeDef Switch_Baud(uint32_t baudRate)
+{
+    if (NEX_Link_Flush(NEX_BAUD_SWITCH_DELAY_MS) != HAL_OK)
+        return HAL_ERROR;
+
+    NEX_Frame_Begin();
+    NEX_Frame_Append_Int(&NEX_BAUD_COMMAND, (int32_t)baudRate);
+    if (NEX_Frame_Commit() != HAL_OK || NEX_Link_Flush(NEX_BAUD_SWITCH_DELAY_MS) != HAL_OK)
+        return HAL_ERROR;
+
+    HAL_Delay(NEX_BAUD_SWITCH_DELAY_MS);
+
+    return Set_Uart_Baud(baudRate);
+}
+
+/**
+  * @brief  Re-initializes the UART at another rate without telling the display.
+  * @param  baudRate: New baud rate.
+  * @retval HAL_OK if the UART was re-initialized, HAL_ERROR otherwise.
+  * @note   The TX queue must be empty.
+  */
+static HAL_StatusTypeDef Set_Uart_Baud(uint32_t baudRate)
+{
+    NEX_Rx_Stop();
+    _uart->Init.BaudRate = baudRate;
+    if (HAL_UART_Init(_uart) != HAL_OK)
+        return HAL_ERROR;
+
+    return NEX_Rx_Start();
+}
+
+/**
+  * @brief  Repeats the "OK"/"con=1" exchange at the current rate.
+  * @param  timeout: Receive timeout per handshake attempt.
+  * @retval HAL_OK if the display answered, HAL_ERROR otherwise.
+  */
+static HAL_StatusTypeDef Verify_Link(uint32_t timeout)
+{
+    NEX_Frame_Begin();
+    NEX_Frame_Append(NEX_RECONNECT_COMMAND);
+    if (NEX_Frame_Commit() != HAL_OK || NEX_Link_Flush(timeout) != HAL_OK)
+        return HAL_ERROR;
+
+    return NEX_Handshake(timeout);
+}
+
+/**
+  * @brief  Watches an upgraded link for a display that rebooted.
+  *
+  *         At the upgraded rate, new framing / noise errors or a probe left
+  *         unanswered for NEX_LINK_PROBE_MS start Recover_Link(). Back at the
+  *         power-on rate, the link is upgraded again once the display is
+  *         ready: it sent 0x88, or prints "OK" while waiting for "con=1".
+  *
+  * @retval None
+  */
+static void Check_Link(void)
+{
+    if (_upgradeBaud == 0)
+        return;     // Power-on rate: the start-up messages are readable
+
+    uint32_t now = HAL_GetTick();
+
+    if (_uart->Init.BaudRate != _upgradeBaud) {
+        if (NEX_Rx_Take_Ok()) {
+            if (_linkLost)
+                Flag_Reboot(now);   // Back after recovery found no one
+            _restoreBaud = 1;
+        }
+        if (!_restoreBaud || _waveWaiting)
+            return;     // Upgrade later; "baud=" would be taken as sample data
+
+        _restoreBaud = 0;
+        _linkLost = (NEX_Upgrade_Baud(_upgradeBaud, NEX_LINK_RECOVERY_TIMEOUT_MS) == HAL_TIMEOUT);
+        if (_uart->Init.BaudRate != _upgradeBaud)
+            NEX_Set_Refresh_Period(_refreshPeriodMs);   // Stays at the power-on rate
+        return;
+    }
+
+    NEX_Rx_Stats rx;
+    NEX_Rx_Get_Stats(&rx);
+    uint8_t lineError = (rx.lineErrors != _lineErrors);
+
+    _lineErrors = rx.lineErrors;
+    _restoreBaud = 0;
+    if (lineError || (_probePending && now - _probeTick >= NEX_LINK_PROBE_MS))
+        Recover_Link();
+}
+
+/**
+  * @brief  Looks for the display after a line error or an unanswered probe.
+  *
+  *         The link is verified at the upgraded rate first, so a noise burst
+  *         costs one "OK"/"con=1" exchange. Otherwise the UART drops to the
+  *         power-on rate, where a rebooted display prints "OK" until it gets
+  *         "con=1". Found there, it is treated as rebooted: the state is
+  *         replayed and Check_Link() upgrades the link again. Found at
+  *         neither rate (still booting, or disconnected), the UART waits at
+  *         the power-on rate for its start-up messages. In binary mode the
+  *         display does not parse "con=0", so the first check is skipped and
+  *         the UART returns to the upgraded rate if the handshake fails.
+  *         A pending waveform transfer is completed first, so that none of
+  *         these commands ends up as sample data.
+  *
+  * @retval None
+  */
+static void Recover_Link(void)
+{
+    NEX_Rx_Stats rx;
+    uint32_t now = HAL_GetTick();
+
+    if (_waveWaiting && Finish_Transfer(1) != HAL_OK)
+        return;     // Retried on the next refresh
+
+    _probePending = 0;
+    _probeTick = now;
+    if (!_binaryMode && Verify_Link(NEX_LINK_RECOVERY_TIMEOUT_MS) == HAL_OK) {
+        NEX_Rx_Get_Stats(&rx);
+        _lineErrors = rx.lineErrors;
+        return;     // Still at the upgraded rate; the resync sweep repairs lost commands
+    }
+
+    NEX_Link_Flush(NEX_LINK_RECOVERY_TIMEOUT_MS);
+    Set_Uart_Baud(_baseBaud);
+    NEX_Set_Refresh_Period(_refreshPeriodMs);
+
+    if (NEX_Handshake(NEX_LINK_RECOVERY_TIMEOUT_MS) == HAL_OK) {
+        Flag_Reboot(now);
+        _restoreBaud = 1;
+    } else if (_binaryMode) {
+        NEX_Link_Flush(NEX_LINK_RECOVERY_TIMEOUT_MS);   // Handshake bytes sent at the power-on rate
+        Set_Uart_Baud(_upgradeBaud);
+        NEX_Set_Refresh_Period(_refreshPeriodMs);
+        NEX_Rx_Get_Stats(&rx);
+        _lineErrors = rx.lineErrors;
+    } else {
+        _linkLost = 1;
+    }
+}
+
+/**
+  * @brief  Reports a display reboot found by the link supervision.
+  * @param  tick: Tick at which the reboot was noticed.
+  * @retval None
+  */
+static void Flag_Reboot(uint32_t tick)
+{
+    _recoveryStats.baudFallbacks++;
+    if (!_rebootPending)
+        _rebootTick = tick;
+    _rebootPending = 1;
+}
+
+/**
+  * @brief  Sets the dirty bit of a widget in its priority class bitmap.
+  * @param  id:  Widget index.
+  * @param  now: Current HAL tick, kept as the start of the update latency.
+  * @retval None
+  */
+static void Set_Dirty(uint8_t id, uint32_t now)
+{
+    uint32_t *word = &_dirty[_widgets[id].config.priority][id / 32U];
+    uint32_t mask = 1UL << (id % 32U);
+
+    if (!(*word & mask)) {
+        *word |= mask;
+        _widgets[id].dirtyTick = now;
+    }
+}
+
+/**
+  * @brief  Marks every registered widget dirty, e.g. after commands were lost.
+  * @retval None
+  */
+static void Mark_All_Dirty(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t id = 0; id < _widgetCount; id++)
+        Set_Dirty(id, now);
+}
+
+/**
+  * @brief  Returns the frame budget after applying overflow throttling.
+  *
+  *         Each overflow reported by the display halves the budget (down to
+  *         1 / 2^NEX_THROTTLE_MAX_SHIFT) and marks all widgets dirty, because it
+  *         is unknown which commands were lost. After NEX_THROTTLE_RECOVERY_FRAMES
+  *         refreshes without a further overflow the budget is doubled again.
+  *
+  * @retval Byte budget for the next frame.
+  */
+static uint16_t Throttled_Budget(void)
+{
+    if (_overflowPending) {
+        _overflowPending = 0;
+        if (_throttleShift < NEX_THROTTLE_MAX_SHIFT)
+            _throttleShift++;
+        _cleanFrames = 0;
+        Mark_All_Dirty();
+    } else if (_throttleShift > 0 && ++_cleanFrames >= NEX_THROTTLE_RECOVERY_FRAMES) {
+        _throttleShift--;
+        _cleanFrames = 0;
+    }
+
+    return _budget >> _throttleShift;
+}
+
+/**
+  * @brief  RX handler of the serial buffer overflow response (0x24).
+  * @param  code:    Return code (NEX_RX_BUFFER_OVERFLOW).
+  * @param  payload: Unused, the response has no payload.
+  * @note   Runs in interrupt context; nex_rx.h has already paused the TX queue.
+  */
+static void Overflow_Handler(uint8_t code, const NEX_RxView *payload)
+{
+    (void)code;
+    (void)payload;
+    _overflowPending = 1;
+}
+
+/**
+  * @brief  RX handler of the start-up (00 00 00) and ready (0x88) messages.
+  * @param  code:    NEX_RX_INVALID_INSTRUCTION or NEX_RX_READY.
+  * @param  payload: Start-up message carries 00 00; a plain 0x00 error has none.
+  * @note   Runs in interrupt context.
+  */
+static void Reboot_Handler(uint8_t code, const NEX_RxView *payload)
+{
+    if (code == NEX_RX_INVALID_INSTRUCTION &&
+        (payload->firstLength + payload->secondLength != 2U ||
+         NEX_Rx_View_Byte(payload, 0) != 0x00U || NEX_Rx_View_Byte(payload, 1) != 0x00U))
+        return;     // Ordinary "invalid instruction" response
+
+    if (code == NEX_RX_READY)
+        _restoreBaud = 1;       // Ready for "baud=" again after an upgrade
+    if (!_rebootPending)
+        _rebootTick = HAL_GetTick();
+    _rebootPending = 1;
+}
+
+/**
+  * @brief  Starts a state replay after a display reboot and detects its end.
+  *
+  *         On a reboot every widget is marked dirty and remembered in the
+  *         restore bitmap; the scheduler then sends them within the normal
+  *         budget. The replay is complete once every remembered widget has been
+  *         sent and the TX queue is empty, i.e. the screen shows the full state.
+  *
+  * @retval None
+  */
+static void Track_Recovery(void)
+{
+    if (_rebootPending) {
+        _rebootPending = 0;
+        _recoveryStats.reboots++;
+        _recoveryStats.restoring = 1;
+        _reconnectPending = 1;
+        _waveWaiting = 0;       // A rebooted display no longer expects samples
+
+        Set_Active_Page(NEX_PAGE_DASHBOARD);    // The display starts on its first page
+        for (uint8_t id = 0; id < _widgetCount; id++)
+            _restorePending[id / 32U] |= 1UL << (id % 32U);
+        for (uint32_t word = 0; word < NEX_WIDGET_WORDS; word++)
+            _restorePending[word] &= _visible[word];
+        Mark_All_Dirty();
+        return;
+    }
+
+    if (!_recoveryStats.restoring || _reconnectPending || NEX_Link_Get_Depth() != 0)
+        return;
+
+    for (uint32_t word = 0; word < NEX_WIDGET_WORDS; word++) {
+        if (_restorePending[word] != 0)
+            return;
+    }
+
+    _recoveryStats.restoring = 0;
+    _recoveryStats.lastRestoreMs = HAL_GetTick() - _rebootTick;
+    if (_recoveryStats.lastRestoreMs > _recoveryStats.worstRestoreMs)
+        _recoveryStats.worstRestoreMs = _recoveryStats.lastRestoreMs;
+}
+
+/**
+  * @brief  Records the page reported by "sendme" (0x66) for the main loop.
+  * @param  code:    NEX_RX_CURRENT_PAGE.
+  * @param  payload: Page ID (1 byte).
+  * @note   Runs in interrupt context.
+  */
+static void Page_Handler(uint8_t code, const NEX_RxView *payload)
+{
+    uint8_t page = NEX_Rx_View_Byte(payload, 0);
+
+    (void)code;
+    if (_probePending) {
+        _probePending = 0;      // Answer to the link probe
+        if (page == _activePage)
+            return;
+    }
+    _reportedPage = page;
+    _pageReported = 1;
+}
+
+/**
+  * @brief  Makes a page active and marks all of its widgets dirty.
+  *
+  *         The display reloads a page with its design-time values, so every
+  *         widget of the new page is pushed, not only the changed ones.
+  *         NEX_PAGE_GLOBAL widgets keep their state.
+  *
+  * @param  page: Page ID now shown on the display.
+  * @retval None
+  */
+static void Set_Active_Page(uint8_t page)
+{
+    uint32_t now = HAL_GetTick();
+
+    _activePage = page;
+    memset(_visible, 0, sizeof(_visible));
+    _trailRedraw = 1;   // A (re)loaded page shows the bare map
+
+    for (uint8_t id = 0; id < _widgetCount; id++) {
+        uint8_t widgetPage = _widgets[id].config.page;
+
+        if (widgetPage != page && widgetPage != NEX_PAGE_GLOBAL)
+            continue;
+
+        _visible[id / 32U] |= 1UL << (id % 32U);
+        if (widgetPage == page)
+            Set_Dirty(id, now);
+    }
+}
+
+/**
+  * @brief  Records the display's answer to "addt".
+  * @param  code:    NEX_RX_TRANSPARENT_READY (0xFE), or NEX_RX_INVALID_COMPONENT /
+  *                  NEX_RX_INVALID_VARIABLE if the display refused the transfer.
+  * @param  payload: Empty.
+  * @note   Runs in interrupt context. The bytes are sent from NEX_Refresh();
+  *         every other function that writes to the display returns HAL_BUSY
+  *         while a transfer is pending.
+  */
+static void Transfer_Handler(uint8_t code, const NEX_RxView *payload)
+{
+    (void)payload;
+    if (code == NEX_RX_TRANSPARENT_READY)
+        _waveReady = 1;
+    else if (_waveWaiting)
+        _waveRefused = 1;   // Wrong component ID or channel; errors outside a transfer are ignored
+}
+
+/**
+  * @brief  Takes the samples that fell due since the last refresh.
+  *
+  *         One sample per elapsed sampleMs, so the time axis stays correct
+  *         when the refresh period is longer than the sample period. A full
+  *         ring drops its oldest sample, so the graph shows the latest
+  *         history. While a transfer of the channel is pending the new sample
+  *         is dropped instead: the display already counts on the announced
+  *         ones, which start at the oldest, and they must stay in place.
+  *
+  * @retval None
+  */
+static void Sample_Waveforms(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < _waveformCount; i++) {
+        NEX_Waveform *wave = &_waveforms[i];
+        const NEX_WaveformConfig *config = &wave->config;
+
+        while (now - wave->lastSampleTick >= config->sampleMs) {
+            int32_t value = config->read(config->source);
+
+            wave->lastSampleTick += config->sampleMs;
+            if (value < config->inMin)
+                value = config->inMin;
+            if (value > config->inMax)
+                value = config->inMax;
+
+            _waveStats.samples++;
+            if (wave->count >= NEX_WAVE_BUFFER_SIZE) {
+                _waveStats.dropped++;
+                if (_waveWaiting && i == _waveActive)
+                    continue;
+                wave->first = (uint8_t)((wave->first + 1U) % NEX_WAVE_BUFFER_SIZE);
+                wave->count--;
+            }
+            wave->samples[(wave->first + wave->count) % NEX_WAVE_BUFFER_SIZE] =
+                (uint8_t)Map_Int(value, config->inMin, config->inMax, 0, config->height);
+            wave->count++;
+        }
+    }
+}
+
+/**
+  * @brief  Runs the addt transfer state machine.
+  *
+  *         Idle: on an empty TX queue, queues "addt" for the next due channel
+  *         on a visible page. Waiting: once 0xFE arrived, queues exactly the
+  *         announced sample bytes, after which the display parses commands
+  *         again. The 0xFD completion needs no wait, the byte count ends the
+  *         transfer on the display.
+  *
+  *         There is no timeout: the display may still be waiting however long
+  *         0xFE takes. The transfer ends without samples only when the display
+  *         refuses it, or reboots (see Track_Recovery()). A line error since
+  *         "addt" may have cost the 0xFE, so the samples are then sent blind.
+  *
+  * @retval HAL_OK if commands may be sent, HAL_BUSY while the display waits for samples.
+  */
+static HAL_StatusTypeDef Service_Waveforms(void)
+{
+    if (!_waveWaiting) {
+        if (_binaryMode || _reconnectPending || _waveformCount == 0 || NEX_Link_Get_Depth() != 0)
+            return HAL_OK;      // A rebooted display gets "con=1" first
+
+        uint32_t now = HAL_GetTick();
+        uint8_t due = 0;
+
+        for (uint8_t visited = 0; visited < _waveformCount && !due; visited++) {
+            NEX_Waveform *wave = &_waveforms[_waveCursor];
+            uint8_t page = wave->config.page;
+
+            due = wave->count > 0 && (page == _activePage || page == NEX_PAGE_GLOBAL) &&
+                  (wave->count >= NEX_WAVE_FLUSH_SAMPLES || now - wave->lastFlushTick >= wave->config.flushMs);
+            if (due)
+                _waveActive = _waveCursor;
+            _waveCursor = (uint8_t)((_waveCursor + 1U) % _waveformCount);
+        }
+        if (!due)
+            return HAL_OK;
+
+        NEX_Waveform *wave = &_waveforms[_waveActive];
+        int32_t args[3] = { wave->config.objectId, wave->config.channel, wave->count };
+
+        NEX_Rx_Stats rx;
+
+        NEX_Rx_Get_Stats(&rx);
+        _waveLineErrors = rx.lineErrors;
+        _waveReady = _waveRefused = 0;
+        NEX_Frame_Begin();
+        if (NEX_Frame_Append_Ints(&NEX_ADDT_COMMAND, args, 3) != HAL_OK || NEX_Frame_Commit() != HAL_OK)
+            return HAL_OK;
+
+        NEX_FrameInfo info;
+        NEX_Frame_Get_Info(&info);
+        _waveStats.bytes += info.size;
+        _waveQuantity = wave->count;
+        _waveWaiting = 1;
+        return HAL_BUSY;        // 0xFE is handled on a later refresh
+    }
+
+    if (_waveRefused) {
+        _waveWaiting = 0;       // Samples are kept for a later channel or page
+        _waveStats.refused++;
+        return HAL_OK;
+    }
+
+    if (!_waveReady) {
+        NEX_Rx_Stats rx;
+
+        NEX_Rx_Get_Stats(&rx);
+        if (rx.lineErrors == _waveLineErrors)
+            return HAL_BUSY;
+        return Finish_Transfer(1);
+    }
+
+    return Finish_Transfer(0);
+}
+
+/**
+  * @brief  Queues the samples announced by the pending "addt".
+  *
+  *         A blind transfer (0xFE not seen) ends with a terminator: a display
+  *         that is waiting takes it as an empty command after the samples,
+  *         one that never started the transfer sees a single invalid command.
+  *
+  * @param  blind: 1 if 0xFE was not received.
+  * @retval HAL_OK if queued, HAL_BUSY if the TX queue is full; the display keeps waiting.
+  */
+static HAL_StatusTypeDef Finish_Transfer(uint8_t blind)
+{
+    NEX_Waveform *wave = &_waveforms[_waveActive];
+    uint8_t upper = NEX_WAVE_BUFFER_SIZE - wave->first;
+    uint8_t head = (_waveQuantity < upper) ? _waveQuantity : upper;
+
+    NEX_Frame_Begin();
+    if (NEX_Frame_Append_Bytes(&wave->samples[wave->first], head) != HAL_OK ||
+        (_waveQuantity > head && NEX_Frame_Append_Bytes(wave->samples, _waveQuantity - head) != HAL_OK) ||
+        (blind && NEX_Frame_Append("") != HAL_OK) ||
+        NEX_Frame_Commit() != HAL_OK)
+        return HAL_BUSY;        // Retry on the next refresh
+
+    wave->first = (uint8_t)((wave->first + _waveQuantity) % NEX_WAVE_BUFFER_SIZE);
+    wave->count -= _waveQuantity;
+    wave->lastFlushTick = HAL_GetTick();
+    _waveStats.transfers++;
+    _waveStats.bytes += _waveQuantity;
+    _waveWaiting = 0;
+    return HAL_OK;
 }
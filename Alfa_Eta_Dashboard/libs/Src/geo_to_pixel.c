@@ -12,11 +12,15 @@
  * converting geographical coordinates to pixel positions on a predefined map layout.
  *
  * It includes:
- *  - Parsing NMEA-formatted GPS strings
+ *  - Reading positions from NMEA sentences in 1e-7 degrees
+ *  - Merging RMC, GGA, GSA and VTG of one epoch into a fix with quality data
  *  - Filtering GPS position data
  *  - Mapping latitude and longitude to x/y pixel coordinates
  *  - Computing directional angle of movement
  *
+ * Positions, distances and the pixel mapping are integer arithmetic; float
+ * is only used for the icon angle.
+ *
  * Designed for use with STM32CubeIDE and STM32 HAL libraries.
  *
  * @note
@@ -34,6 +38,10 @@
 
 #include "geo_to_pixel.h"
 
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+#include "cycle_counter.h"
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 
 /**
@@ -41,11 +49,6 @@
  */
 static UART_HandleTypeDef *_uart = NULL;
 
-/**
- * @brief Buffer to store raw NMEA sentences received from the GPS module.
- */
-char gps_buffer[GPS_BUFFER_SIZE];
-
 /**
  * @brief  Pointer to the external map data structure used to update display elements such as position,
  * 		   direction, and lap count.
@@ -66,11 +69,12 @@ static MapOffset _mapCachedData = {
  * @brief Internal GPS data structure containing raw and filtered coordinates, as well as speed.
  */
 static GPS_Data _gpsData = {
-    .speed      = 0.00f,
-    .last_lat   = 0.00f,
-    .last_lon   = 0.00f,
-    .raw_lat    = 0.00f,
-    .raw_lon    = 0.00f
+    .speed      = 0,
+    .last_lat   = 0,
+    .last_lon   = 0,
+    .raw_lat    = 0,
+    .raw_lon    = 0,
+    .fix        = {.time = GPS_TIME_UNKNOWN}
 };
 
 /**
@@ -79,11 +83,11 @@ static GPS_Data _gpsData = {
  * Each checkpoint holds a status flag (0 = not reached, 1 = reached),
  * along with latitude and longitude coordinates.
  */
-static GPS_Checkpoint Checkpoints[3] = {
-    {.status = 0, .lat = 40.78743065f, .lon = 29.45139832f},  // Start point
-	{.status = 0, .lat = 40.78848651f, .lon = 29.45713582f},
-	{.status = 0, .lat = 40.7872771f, .lon = 29.4576436f},
-	{.status = 0, .lat = 40.7857818f, .lon = 29.4539718f}
+static GPS_Checkpoint Checkpoints[] = {
+    {.status = 0, .lat = 407874306, .lon = 294513983},  // Start point
+	{.status = 0, .lat = 407884865, .lon = 294571358},
+	{.status = 0, .lat = 407872771, .lon = 294576436},
+	{.status = 0, .lat = 407857818, .lon = 294539718}
 };
 
 
@@ -92,6 +96,31 @@ static GPS_Checkpoint Checkpoints[3] = {
  */
 static uint8_t Is_Lap_Started = 0;
 
+/**
+ * @brief Result of the epochs completed in the current pipeline run.
+ *        HAL_BUSY until one completes, then HAL_OK once one has a usable fix.
+ */
+static HAL_StatusTypeDef _fixStatus = HAL_BUSY;
+
+/**
+ * @brief Epoch being assembled from the sentences of one receiver output cycle.
+ */
+static GPS_Fix _epoch = {.time = GPS_TIME_UNKNOWN};
+
+static uint8_t _expected = 0;          /*!< Sentences of a full epoch, learned; 0 = not known yet */
+static uint8_t _positionRejected = 0;  /*!< A sentence of _epoch flagged the position invalid */
+
+/**
+ * @brief Position, speed and result in effect before the last epoch was
+ *        completed, restored if a trailing sentence makes that fix unusable.
+ */
+static struct {
+    int32_t lat;
+    int32_t lon;
+    int32_t speed;
+    HAL_StatusTypeDef status;
+} _beforeFix;
+
 
 /* Private Constants ---------------------------------------------------------*/
 /* Private macros ------------------------------------------------------------*/
@@ -101,20 +130,50 @@ static uint8_t Is_Lap_Started = 0;
  */
 #define NUM_CHECKPOINTS (sizeof(Checkpoints)/sizeof(Checkpoints[0]))
 
+/**
+ * @brief Movements below this distance are treated as GPS jitter (3 m).
+ */
+#define FILTER_DISTANCE_MM 3000
+
+/**
+ * @brief A checkpoint counts as reached within this distance (5 m).
+ */
+#define CHECKPOINT_RADIUS_MM 5000
+
+/**
+ * @brief Components larger than this saturate, so squared distances fit int64_t.
+ */
+#define DISTANCE_LIMIT_MM 1000000000LL
+
 /* Private function prototypes -----------------------------------------------*/
 /** @addtogroup Geo_To_Pixel_Private_Functions
   * @{
   */
-static HAL_StatusTypeDef Read_GPS_Location(void);
-static float NMEA_To_Decimal(char *nmea);
+static void Read_GPS_Location(const NMEA_Sentence *sentence);
+static void Read_GGA(const NMEA_Sentence *sentence);
+static void Read_GSA(const NMEA_Sentence *sentence);
+static void Read_VTG(const NMEA_Sentence *sentence);
+static GPS_Fix *Join_Epoch(uint32_t time, uint8_t sentence);
+static void Check_Epoch(uint8_t force);
+static void Complete_Epoch(void);
+static void Amend_Fix(void);
+static void Publish_Fix(void);
+static uint8_t Fix_Is_Usable(const GPS_Fix *fix);
+static uint32_t Parse_Time(const char *field);
+static uint16_t Parse_Dop(const char *field);
 static void GPS_Filter(GPS_Data *gps);
-static float GPS_CalcDistance(float lat1, float lon1, float lat2, float lon2);
+static int64_t GPS_Distance_Squared(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+static int32_t Geo_To_Map(int32_t value, int32_t min, int32_t max, int32_t size);
 static void Calculate_Geo_To_Pixel(void);
 static void Get_Map_Draw_Position(int gpsPixelX, int gpsPixelY);
 static void Calculate_Icon_Angle(void);
 static void Count_Lap(void);
 static uint8_t Is_Lap_Complete(void);
 static void Clear_Checkpoints(void);
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+static float NMEA_To_Decimal(const char *nmea);
+static float GPS_CalcDistance(float lat1, float lon1, float lat2, float lon2);
+#endif
 /**
   * @}
   */
@@ -155,27 +214,53 @@ HAL_StatusTypeDef Geo_To_Pixel_Bind(UART_HandleTypeDef *uart, MapOffset *mapData
 
 	_uart = uart;
     _mapData = mapData;
-    return HAL_OK;
+    Map_Trail_Reset();
+
+    NMEA_Parser_Init();
+    _epoch.sentences = 0;
+    _gpsData.fix.sentences = 0;
+    _expected = 0;
+
+    // Any talker: GP (GPS), GL (GLONASS), GA (Galileo), GB (BeiDou), GN (combined)
+    if (NMEA_Parser_Register_Handler("--RMC", Read_GPS_Location) != HAL_OK
+        || NMEA_Parser_Register_Handler("--GGA", Read_GGA) != HAL_OK
+        || NMEA_Parser_Register_Handler("--GSA", Read_GSA) != HAL_OK
+        || NMEA_Parser_Register_Handler("--VTG", Read_VTG) != HAL_OK)
+        return HAL_ERROR;
+
+    return GPS_Rx_Init(uart);   // Background reception from here on
 }
 
 /**
   * @brief  Executes the full geolocation processing pipeline:
-  *         - Reads GPS location over UART
+  *         - Feeds the bytes received in the background (gps_rx.h) to the
+  *           NMEA parser, whose handlers merge RMC, GGA, GSA and VTG into
+  *           one fix per epoch and keep the position of usable fixes
   *         - Filters GPS signal to reduce noise
   *         - Maps filtered coordinates to pixel values on screen
   *         - Computes icon orientation angle based on movement direction
   *         - Detects lap completion and increments lap count
   * @retval HAL_StatusTypeDef
   *         - HAL_OK: All pipeline stages completed successfully.
-  *         - HAL_ERROR: GPS data could not be read.
+  *         - HAL_BUSY: No epoch was completed since the last call.
+  *         - HAL_ERROR: Epochs were completed, but none had a usable fix
+  *           (invalid, or rejected by GPS_MAX_HDOP / GPS_MIN_SATELLITES).
   *
   * @note   This function assumes internal bindings are already set via Geo_To_Pixel_Bind().
   *         Should be called periodically (e.g., in a timer or main loop) to keep UI updated.
+  *         It never waits for the GPS; the main loop must run at least every
+  *         half second so the reception buffer does not overrun.
   */
 HAL_StatusTypeDef Geo_To_Pixel_Run_Pipeline(void)
 {
+	const uint8_t *data;
+	uint16_t length;
+
+	_fixStatus = HAL_BUSY;
+	while ((length = GPS_Rx_Read(&data)) != 0)
+		NMEA_Parser_Feed(data, length);   // Calls the sentence handlers below
 
-	if(Read_GPS_Location() == HAL_OK){
+	if(_fixStatus == HAL_OK){
 
 		GPS_Filter(&_gpsData);
 
@@ -184,127 +269,330 @@ HAL_StatusTypeDef Geo_To_Pixel_Run_Pipeline(void)
 		Calculate_Icon_Angle();
 
 		Count_Lap();
-
-		return HAL_OK;
 	}
 
-	return HAL_ERROR;
+	return _fixStatus;
+}
+
+/**
+  * @brief  Returns the most recent complete epoch.
+  * @retval Pointer to the fix record in _gpsData.
+  */
+const GPS_Fix *Geo_To_Pixel_Get_Fix(void)
+{
+	return &_gpsData.fix;
 }
 
 /**
-  * @brief  Reads raw GPS data from UART via UART, searches for $GNRMC NMEA sentence,
-  *         extracts status, latitude, longitude, and speed fields.
-  *         Converts latitude and longitude to decimal degrees with NMEA_To_Decimal(),
-  *         applies hemisphere corrections, and updates global _gpsData struct.
+  * @brief  Handler of the RMC sentence of any talker (nmea_parser.h); the
+  *         checksum has already been validated. Reads time, status,
+  *         latitude, longitude, speed and course fields in place.
+  *         Converts latitude and longitude to 1e-7 degrees with
+  *         NMEA_Parser_To_Coordinate() (hemisphere included), and the speed
+  *         to 0.01 km/h, without float, and merges them into the epoch.
+  *
+  * @param  sentence: Parsed sentence, field 0 being e.g. "GNRMC" or "GPRMC".
   *
-  * @note   Uses internal global buffer 'gps_buffer' to store received UART data.
-  *         Updates raw_lat, raw_lon, and speed fields in _gpsData.
+  * @note   The speed is only taken when the epoch has no VTG, which carries
+  *         km/h directly.
   *
-  * @retval HAL_OK if a valid $GNRMC sentence is found and parsed, otherwise HAL_ERROR.
+  * @retval None
   */
-static HAL_StatusTypeDef Read_GPS_Location(void)
+static void Read_GPS_Location(const NMEA_Sentence *sentence)
 {
-    float latitude = 0.0f, longitude = 0.0f;
-
-    // Clear GPS UART buffer
-    memset(gps_buffer, 0, GPS_BUFFER_SIZE);
-    HAL_UART_Receive(_uart, (uint8_t *)gps_buffer, GPS_BUFFER_SIZE, 1000);
-
-    // Search for $GNRMC sentence start in buffer
-    char *start = gps_buffer;
-    while ((start = strstr(start, "$GNRMC")) != NULL) {
-
-        char temp_buf[GPS_BUFFER_SIZE];
-        strncpy(temp_buf, start, GPS_BUFFER_SIZE - 1);
-        temp_buf[GPS_BUFFER_SIZE - 1] = '\0';
-
-        char *token = strtok(temp_buf, ",");
-        int fieldIndex = 0;
-
-        char status 	= 0;
-        char *latStr 	= NULL;
-        char *latDir 	= NULL;
-        char *lonStr 	= NULL;
-        char *lonDir 	= NULL;
-        char *speedStr	= NULL;
-
-        while (token != NULL) {
-            switch (fieldIndex) {
-                case 2:
-                    status = token[0]; // 'A' = valid fix, 'V' = invalid
-                    break;
-                case 3:
-                    latStr = token;
-                    break;
-                case 4:
-                    latDir = token;
-                    break;
-                case 5:
-                    lonStr = token;
-                    break;
-                case 6:
-                    lonDir = token;
-                    break;
-                case 7:
-                    speedStr = token;
-                    break;
+    int32_t latitude, longitude, value;
+    uint32_t time = Parse_Time(NMEA_Parser_Field(sentence, 1));
+
+    if (Join_Epoch(time, GPS_SENTENCE_RMC) == NULL)
+        return;
+
+    char status = NMEA_Parser_Field(sentence, 2)[0];  // 'A' = valid fix, 'V' = invalid
+    char mode = NMEA_Parser_Field(sentence, 12)[0];   // NMEA 2.3+: 'N' = no fix, 'E' = estimated
+
+    // Validate fix and presence of required fields
+    if (status == 'A' && mode != 'N' && mode != 'E'
+        && NMEA_Parser_To_Coordinate(NMEA_Parser_Field(sentence, 3), NMEA_Parser_Field(sentence, 4), &latitude) == HAL_OK
+        && NMEA_Parser_To_Coordinate(NMEA_Parser_Field(sentence, 5), NMEA_Parser_Field(sentence, 6), &longitude) == HAL_OK) {
+        _epoch.lat = latitude;
+        _epoch.lon = longitude;
+        _epoch.valid = 1;
+    } else {
+        _positionRejected = 1;
+    }
 
-            }
+    // Convert speed from 0.001 knots to 0.01 km/h (1 kn = 1.852 km/h)
+    if (!(_epoch.sentences & GPS_SENTENCE_VTG)
+        && NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 7), 3, &value) == HAL_OK)
+        _epoch.speed = (int32_t)(((int64_t)value * 1852 + 5000) / 10000);
 
-            fieldIndex++;
-            token = strtok(NULL, ",");
-        }
+    if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 8), 2, &value) == HAL_OK)
+        _epoch.course = value;
+
+    Check_Epoch(time == GPS_TIME_UNKNOWN);
+}
 
-        // Validate fix and presence of required fields
-        if (status == 'A' && latStr && lonStr && latDir && lonDir) {
-            latitude = NMEA_To_Decimal(latStr);
-            if (latDir[0] == 'S') latitude = -latitude;
+/**
+  * @brief  Handler of the GGA sentence of any talker: time, position, fix
+  *         quality, satellites in use, HDOP and altitude.
+  * @param  sentence: Parsed sentence.
+  * @retval None
+  */
+static void Read_GGA(const NMEA_Sentence *sentence)
+{
+    int32_t latitude, longitude, value;
+    uint32_t time = Parse_Time(NMEA_Parser_Field(sentence, 1));
+
+    if (Join_Epoch(time, GPS_SENTENCE_GGA) == NULL)
+        return;
+
+    if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 6), 0, &value) == HAL_OK)
+        _epoch.quality = (uint8_t)value;
+
+    if (_epoch.quality != 0 && _epoch.quality != 6
+        && NMEA_Parser_To_Coordinate(NMEA_Parser_Field(sentence, 2), NMEA_Parser_Field(sentence, 3), &latitude) == HAL_OK
+        && NMEA_Parser_To_Coordinate(NMEA_Parser_Field(sentence, 4), NMEA_Parser_Field(sentence, 5), &longitude) == HAL_OK) {
+        _epoch.lat = latitude;
+        _epoch.lon = longitude;
+        _epoch.valid = 1;
+    } else {
+        _positionRejected = 1;    // Quality 0 = no fix, 6 = dead reckoning
+    }
 
-            longitude = NMEA_To_Decimal(lonStr);
-            if (lonDir[0] == 'W') longitude = -longitude;
+    if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 7), 0, &value) == HAL_OK)
+        _epoch.satellites = (uint8_t)value;
 
-            // Convert speed from knots to km/h
-            if (speedStr) {
-                float speedKnots = atof(speedStr);
-                float speedKmph = speedKnots * 1.852f;
-                _gpsData.speed = speedKmph;
-            }
+    _epoch.hdop = Parse_Dop(NMEA_Parser_Field(sentence, 8));
+
+    if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 9), 2, &value) == HAL_OK)
+        _epoch.altitude = value;
+
+    Check_Epoch(time == GPS_TIME_UNKNOWN);
+}
+
+/**
+  * @brief  Handler of the GSA sentence of any talker: fix type and DOPs.
+  *         A combined (GN) receiver sends one GSA per constellation with the
+  *         same fix type and DOPs. Once the sentence set is learned, the
+  *         first one completes the epoch and the others are merged into the
+  *         completed fix (see Join_Epoch()).
+  * @param  sentence: Parsed sentence.
+  * @retval None
+  */
+static void Read_GSA(const NMEA_Sentence *sentence)
+{
+    int32_t value;
+    GPS_Fix *fix = Join_Epoch(GPS_TIME_UNKNOWN, GPS_SENTENCE_GSA);
+
+    if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 2), 0, &value) == HAL_OK)
+        fix->fixType = (uint8_t)value;
+
+    fix->pdop = Parse_Dop(NMEA_Parser_Field(sentence, 15));
+    fix->hdop = Parse_Dop(NMEA_Parser_Field(sentence, 16));
+    fix->vdop = Parse_Dop(NMEA_Parser_Field(sentence, 17));
+
+    if (fix == &_epoch)
+        Check_Epoch(0);
+    else
+        Amend_Fix();
+}
+
+/**
+  * @brief  Handler of the VTG sentence of any talker: course and speed in km/h.
+  * @param  sentence: Parsed sentence.
+  * @retval None
+  */
+static void Read_VTG(const NMEA_Sentence *sentence)
+{
+    int32_t value;
+    GPS_Fix *fix = Join_Epoch(GPS_TIME_UNKNOWN, GPS_SENTENCE_VTG);
+
+    if (NMEA_Parser_Field(sentence, 9)[0] != 'N') {  // NMEA 2.3+: 'N' = data not valid
+        if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 1), 2, &value) == HAL_OK)
+            fix->course = value;
+        if (NMEA_Parser_To_Fixed(NMEA_Parser_Field(sentence, 7), 2, &value) == HAL_OK)
+            fix->speed = value;
+    }
+
+    if (fix == &_epoch)
+        Check_Epoch(0);
+    else
+        Amend_Fix();
+}
+
+/**
+  * @brief  Adds a sentence to the epoch being assembled.
+  *
+  *         RMC and GGA carry the UTC time and delimit the epochs; GSA and VTG
+  *         belong to the epoch they arrive in. A new time completes the
+  *         previous epoch and teaches which sentences a full epoch holds
+  *         (_expected), so the following epochs complete as soon as their
+  *         last sentence arrives instead of one epoch later.
+  *
+  *         A GSA or VTG that arrives after completion, before the next
+  *         time, trails the completed epoch (e.g. the second GSA of a GN
+  *         receiver) and is merged into _gpsData.fix; it never starts the
+  *         next epoch.
+  *
+  * @param  time:     UTC time of the sentence, GPS_TIME_UNKNOWN if it has none.
+  * @param  sentence: GPS_SENTENCE_* bit of the sentence.
+  * @retval Fix to merge the sentence into: &_epoch, &_gpsData.fix, or NULL
+  *         if it carries the time of the completed epoch and is dropped.
+  *         Never NULL for GSA and VTG, never &_gpsData.fix for RMC and GGA.
+  */
+static GPS_Fix *Join_Epoch(uint32_t time, uint8_t sentence)
+{
+    if (time != GPS_TIME_UNKNOWN && _epoch.sentences != 0
+        && _epoch.time != GPS_TIME_UNKNOWN && time != _epoch.time) {
+        _expected = _epoch.sentences;       // Ended by the next epoch: this is a full set
+        Complete_Epoch();
+    }
 
-            // Update GPS raw coordinates
-            _gpsData.raw_lat = latitude;
-            _gpsData.raw_lon = longitude;
+    if (_epoch.sentences == 0) {
+        if (time != GPS_TIME_UNKNOWN && time == _gpsData.fix.time) {
+            _expected |= sentence;          // Arrived after the epoch was completed; wait for it next time
+            return NULL;
+        }
 
-            return HAL_OK; // Valid sentence processed, exit loop
+        if ((sentence & (GPS_SENTENCE_GSA | GPS_SENTENCE_VTG)) && _gpsData.fix.sentences != 0) {
+            _gpsData.fix.sentences |= sentence;
+            return &_gpsData.fix;
         }
+
+        memset(&_epoch, 0, sizeof(_epoch));
+        _epoch.time = GPS_TIME_UNKNOWN;
+        _positionRejected = 0;
+    }
+
+    if (time != GPS_TIME_UNKNOWN)
+        _epoch.time = time;
+
+    _epoch.sentences |= sentence;
+    return &_epoch;
+}
+
+/**
+  * @brief  Completes the epoch once all expected sentences are merged.
+  * @param  force: 1 to complete it anyway (a position sentence without time).
+  * @retval None
+  */
+static void Check_Epoch(uint8_t force)
+{
+    if (force || (_expected != 0 && (_epoch.sentences & _expected) == _expected))
+        Complete_Epoch();
+}
+
+/**
+  * @brief  Publishes the epoch as _gpsData.fix and, if it is usable, its
+  *         position and speed for the rest of the pipeline.
+  * @retval None
+  */
+static void Complete_Epoch(void)
+{
+    if (_positionRejected)
+        _epoch.valid = 0;       // RMC and GGA must agree on a valid position
+
+    _beforeFix.lat = _gpsData.raw_lat;
+    _beforeFix.lon = _gpsData.raw_lon;
+    _beforeFix.speed = _gpsData.speed;
+    _beforeFix.status = _fixStatus;
+
+    _gpsData.fix = _epoch;
+    _epoch.sentences = 0;
+
+    Publish_Fix();
+}
+
+/**
+  * @brief  Re-evaluates the completed fix after a trailing sentence was
+  *         merged into it, as long as the pipeline has not consumed it yet.
+  * @note   A trailing sentence that arrives in a later pipeline run is only
+  *         kept in _gpsData.fix; the position it belongs to was already used.
+  * @retval None
+  */
+static void Amend_Fix(void)
+{
+    if (_fixStatus != HAL_BUSY)   // Completed in this run
+        Publish_Fix();
+}
+
+/**
+  * @brief  Takes the position and speed of _gpsData.fix if it is usable,
+  *         otherwise keeps those in effect before it was completed.
+  * @retval None
+  */
+static void Publish_Fix(void)
+{
+    if (Fix_Is_Usable(&_gpsData.fix)) {
+        _gpsData.raw_lat = _gpsData.fix.lat;
+        _gpsData.raw_lon = _gpsData.fix.lon;
+        _gpsData.speed = _gpsData.fix.speed;
+        _fixStatus = HAL_OK;
+    } else {
+        _gpsData.raw_lat = _beforeFix.lat;
+        _gpsData.raw_lon = _beforeFix.lon;
+        _gpsData.speed = _beforeFix.speed;
+        _fixStatus = (_beforeFix.status == HAL_OK) ? HAL_OK : HAL_ERROR;
     }
-    return HAL_ERROR;
 }
 
 /**
-  * @brief  Parses NMEA coordinate string and converts it to decimal degrees.
+  * @brief  Decides whether a fix is good enough to move the vehicle.
   *
-  *         Extracts degree and minute parts from the string, then returns
-  *         decimal representation (degrees + minutes/60).
+  *         Quality fields the receiver did not send (0) are not checked, so
+  *         an RMC-only receiver still works.
   *
-  * @param  nmea: NMEA coordinate string (e.g. "4916.45" or "12311.12").
-  * @retval Decimal degrees as float.
+  * @param  fix: Completed epoch.
+  * @retval 1 if the position can be used, 0 otherwise.
   */
-static float NMEA_To_Decimal(char *nmea)
+static uint8_t Fix_Is_Usable(const GPS_Fix *fix)
 {
-    if (nmea == NULL) return 0.0f;
+    if (!fix->valid)
+        return 0;
+    if (fix->fixType == 1)                                  // GSA: no fix
+        return 0;
+    if (fix->hdop != 0 && fix->hdop > GPS_MAX_HDOP)
+        return 0;
+    if ((fix->sentences & GPS_SENTENCE_GGA) && fix->satellites < GPS_MIN_SATELLITES)
+        return 0;
+
+    return 1;
+}
 
-    int degrees = 0;
-    float minutes = 0.0f;
-    char deg_buff[4] = {0};
+/**
+  * @brief  Converts an NMEA time field (hhmmss.ss) to 0.01 s since midnight.
+  * @param  field: Time field.
+  * @retval Time, or GPS_TIME_UNKNOWN for an empty or malformed field.
+  */
+static uint32_t Parse_Time(const char *field)
+{
+    int32_t value;
 
-    int len = strchr(nmea, '.') - nmea;
-    int deg_digits = (len > 4) ? 3 : 2;
+    if (NMEA_Parser_To_Fixed(field, 2, &value) != HAL_OK || value < 0)
+        return GPS_TIME_UNKNOWN;
 
-    strncpy(deg_buff, nmea, deg_digits);
-    degrees = atoi(deg_buff);
-    minutes = atof(nmea + deg_digits);
+    uint32_t hours = (uint32_t)value / 1000000U;
+    uint32_t minutes = ((uint32_t)value / 10000U) % 100U;
+    uint32_t centiseconds = (uint32_t)value % 10000U;
 
-    return degrees + (minutes / 60.0f);
+    if (hours > 23U || minutes > 59U || centiseconds > 6099U)   // 60.xx: leap second
+        return GPS_TIME_UNKNOWN;
+
+    return (hours * 3600U + minutes * 60U) * 100U + centiseconds;
+}
+
+/**
+  * @brief  Converts a DOP field to x100.
+  * @param  field: DOP field, e.g. "1.25".
+  * @retval DOP x100 (99.99 at most), 0 if the field is empty.
+  */
+static uint16_t Parse_Dop(const char *field)
+{
+    int32_t value;
+
+    if (NMEA_Parser_To_Fixed(field, 2, &value) != HAL_OK || value <= 0)
+        return 0;
+
+    return (value > 9999) ? 9999U : (uint16_t)value;
 }
 
 /**
@@ -312,6 +600,9 @@ static float NMEA_To_Decimal(char *nmea)
   *
   *         Calculates distance between current raw and last known positions.
   *         If distance < 3 meters, keeps previous filtered coordinates to avoid jitter.
+  *         With an HDOP above 1 the deadband grows in proportion, so a less
+  *         precise fix has to move further before it is trusted.
+  *         The comparison is done on squared millimetres, so no square root is taken.
   *         Otherwise, updates filtered and last coordinates with new raw data.
   *
   * @param  gps: Pointer to GPS_Data struct containing raw, filtered, and last coordinates.
@@ -319,9 +610,13 @@ static float NMEA_To_Decimal(char *nmea)
   */
 static void GPS_Filter(GPS_Data *gps)
 {
-    float dist = GPS_CalcDistance(gps->raw_lat, gps->raw_lon, gps->last_lat, gps->last_lon);
+    int64_t dist2 = GPS_Distance_Squared(gps->raw_lat, gps->raw_lon, gps->last_lat, gps->last_lon);
+    int64_t deadband = FILTER_DISTANCE_MM;
 
-    if ( dist < 3.0f) { //gps->speed < 1.0f ||
+    if (gps->fix.hdop > 100)
+        deadband = deadband * gps->fix.hdop / 100;
+
+    if (dist2 < deadband * deadband) { //gps->speed < 1.0f ||
     	// No significant movement, keep previous filtered values
         gps->filtered_lat = gps->last_lat;
         gps->filtered_lon = gps->last_lon;
@@ -337,28 +632,32 @@ static void GPS_Filter(GPS_Data *gps)
 }
 
 /**
-  * @brief  Computes distance in meters between two geographic coordinates.
-  *         Uses the Haversine formula accounting for earth's curvature.
+  * @brief  Computes the squared distance in mm^2 between two coordinates.
   *
-  * @param  lat1: Latitude of start point (degrees).
-  * @param  lon1: Longitude of start point (degrees).
-  * @param  lat2: Latitude of end point (degrees).
-  * @param  lon2: Longitude of end point (degrees).
+  *         Equirectangular approximation: the latitude difference is scaled
+  *         to millimetres, the longitude difference additionally by the
+  *         cosine of the map latitude. Over a few kilometres this differs
+  *         from the haversine distance by far less than the GPS resolution.
   *
-  * @retval Distance in meters.
+  * @param  lat1: Latitude of start point (1e-7 degrees).
+  * @param  lon1: Longitude of start point (1e-7 degrees).
+  * @param  lat2: Latitude of end point (1e-7 degrees).
+  * @param  lon2: Longitude of end point (1e-7 degrees).
+  *
+  * @retval Squared distance in mm^2; saturates for points more than
+  *         DISTANCE_LIMIT_MM apart on either axis.
   */
-static float GPS_CalcDistance(float lat1, float lon1, float lat2, float lon2)
+static int64_t GPS_Distance_Squared(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2)
 {
-    const float R = 6371000.0f; // earth radius in meters
-    float dLat = (lat2 - lat1) * (M_PI / 180.0f);
-    float dLon = (lon2 - lon1) * (M_PI / 180.0f);
+    int64_t north = (((int64_t)lat2 - lat1) * GEO_MM_PER_UNIT_Q16) >> 16;
+    int64_t east = (((((int64_t)lon2 - lon1) * GEO_MM_PER_UNIT_Q16) >> 16) * GEO_COS_LAT_Q16) >> 16;
 
-    float a = sinf(dLat/2) * sinf(dLat/2) +
-              cosf(lat1 * M_PI / 180.0f) * cosf(lat2 * M_PI / 180.0f) *
-              sinf(dLon/2) * sinf(dLon/2);
+    if (north > DISTANCE_LIMIT_MM || north < -DISTANCE_LIMIT_MM)
+        north = DISTANCE_LIMIT_MM;
+    if (east > DISTANCE_LIMIT_MM || east < -DISTANCE_LIMIT_MM)
+        east = DISTANCE_LIMIT_MM;
 
-    float c = 2 * atan2f(sqrtf(a), sqrtf(1-a));
-    return R * c; // distance in meters
+    return north * north + east * east;
 }
 
 /**
@@ -368,14 +667,29 @@ static float GPS_CalcDistance(float lat1, float lon1, float lat2, float lon2)
   */
 static void Calculate_Geo_To_Pixel(void)
 {
-	float mappedXf = Map_Float(_gpsData.filtered_lon, NW_lon, SE_lon, 0.00f , MAP_X_SIZE);
-	int mappedX = (int)mappedXf;
+	int mappedX = Geo_To_Map(_gpsData.filtered_lon, NW_lon, SE_lon, MAP_X_SIZE);
 
-	float mappedYf = Map_Float(_gpsData.filtered_lat, NW_lat, SE_lat, 0.00f, MAP_Y_SIZE);
-	int mappedY = (int)mappedYf;
+	int mappedY = Geo_To_Map(_gpsData.filtered_lat, NW_lat, SE_lat, MAP_Y_SIZE);
 	Get_Map_Draw_Position(mappedX, mappedY);
 }
 
+/**
+  * @brief  Maps a coordinate between two map edges to a pixel.
+  *
+  *         Same result as Map_Float() followed by a cast to int, computed in
+  *         int64_t so positions far off the map cannot overflow.
+  *
+  * @param  value: Coordinate in 1e-7 degrees.
+  * @param  min:   Coordinate of pixel 0.
+  * @param  max:   Coordinate of pixel size.
+  * @param  size:  Map size in pixels along this axis.
+  * @retval Pixel position, truncated toward zero.
+  */
+static int32_t Geo_To_Map(int32_t value, int32_t min, int32_t max, int32_t size)
+{
+	return (int32_t)(((int64_t)value - min) * size / ((int64_t)max - min));
+}
+
 /**
   * @brief  Calculates and clamps the pixel position for drawing the icon on the map.
   *
@@ -388,6 +702,8 @@ static void Calculate_Geo_To_Pixel(void)
   * @note   ICON_X and ICON_Y define the base drawing position of the icon on screen.
   *         ICON_WIDTH/HEIGHT offsets center the icon correctly.
   *         Resulting pixel coordinates are clamped between MAP_X_MIN_VAL/MAX and MAP_Y_MIN_VAL/MAX.
+  *         The unclamped GPS pixel is added to the driven-path trail, which
+  *         limits it to +-MAP_TRAIL_LIMIT itself (map_trail.h).
   *
   * @retval None
   */
@@ -395,6 +711,8 @@ static void Get_Map_Draw_Position(int gpsPixelX, int gpsPixelY)
 {
 	int pixelX, pixelY;
 
+	Map_Trail_Add(gpsPixelX, gpsPixelY);   // Before clamping: the trail keeps the true position
+
 	pixelX = ICON_X + (int)(ICON_WIDTH/2) - gpsPixelX;
 
 	if(pixelX < MAP_X_MIN_VAL)
@@ -471,22 +789,27 @@ static void Calculate_Icon_Angle(void)
  *   it marks the lap as started.
  *
  * The function uses:
- *  - `GPS_CalcDistance()` to calculate proximity
+ *  - `GPS_Distance_Squared()` to calculate proximity
  *  - `Is_Lap_Complete()` to verify lap completion
  *  - `Clear_Checkpoints()` to reset states
  *
+ * Nothing is counted while the HDOP of the fix is above GPS_LAP_MAX_HDOP.
+ *
  * Typical usage:
  *  - Call this after filtering GPS data, ideally inside a geo update pipeline.
  ******************************************************************************
  */
 static void Count_Lap(void)
 {
-    for (int index = 0; index < NUM_CHECKPOINTS; index++) {
+    if (_gpsData.fix.hdop > GPS_LAP_MAX_HDOP)
+        return;     // Too imprecise to decide on a 5 m checkpoint radius
+
+    for (uint32_t index = 0; index < NUM_CHECKPOINTS; index++) {
         GPS_Checkpoint *point = &Checkpoints[index];
-        float distance = GPS_CalcDistance(point->lat, point->lon,
-                                          _gpsData.filtered_lat, _gpsData.filtered_lon);
+        int64_t distance2 = GPS_Distance_Squared(point->lat, point->lon,
+                                                 _gpsData.filtered_lat, _gpsData.filtered_lon);
 
-        if (distance < 5.0f) { // close enough to a checkpoint
+        if (distance2 < (int64_t)CHECKPOINT_RADIUS_MM * CHECKPOINT_RADIUS_MM) { // close enough to a checkpoint
 
             if (index == 0) { // you're at the starting point
 
@@ -496,6 +819,7 @@ static void Count_Lap(void)
 
                     if (Is_Lap_Complete()) {
                         _mapData->Lap++;  // lap completed
+                        Map_Trail_Reset();  // the trail shows the current lap only
                     }
 
                     Clear_Checkpoints();
@@ -530,7 +854,7 @@ static void Count_Lap(void)
  */
 static uint8_t Is_Lap_Complete(void)
 {
-	for (int index=0; index<sizeof(Checkpoints)/sizeof(Checkpoints[0]); index++){
+	for (uint32_t index=0; index<NUM_CHECKPOINTS; index++){
 		if(Checkpoints[index].status == 0) return 0;
 	}
 	return 1;
@@ -551,7 +875,130 @@ static uint8_t Is_Lap_Complete(void)
  */
 static void Clear_Checkpoints(void)
 {
-	for (int index=0; index<sizeof(Checkpoints)/sizeof(Checkpoints[0]); index++){
+	for (uint32_t index=0; index<NUM_CHECKPOINTS; index++){
 		Checkpoints[index].status = 0;
 	}
 }
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+  * @brief  Measures the position path before and after the fixed-point change.
+  *
+  *         The float path is the former one: NMEA_To_Decimal(), the haversine
+  *         GPS_CalcDistance() and Map_Float(). The fixed-point path is
+  *         NMEA_Parser_To_Coordinate(), GPS_Distance_Squared() and
+  *         Geo_To_Map(). The float error is the distance between the float
+  *         position and the exact fixed-point one.
+  *
+  * @param  iterations: Passes over the samples.
+  * @param  result:     Destination for the measurement.
+  * @retval None
+  */
+void Geo_To_Pixel_Benchmark(uint32_t iterations, GeoPixelBenchmark *result)
+{
+    static const char *const samples[][2] = {
+        {"4047.24583", "02927.08390"},
+        {"4047.30912", "02927.42815"},
+        {"4047.19874", "02927.36290"},
+        {"4047.13471", "02927.19057"}
+    };
+    const uint32_t count = sizeof(samples) / sizeof(samples[0]);
+    const float checkLat = Checkpoints[0].lat / 1e7f, checkLon = Checkpoints[0].lon / 1e7f;
+    uint32_t floatTotal = 0, fixedTotal = 0;
+    volatile int32_t sink;
+    double worst = 0.0;
+
+    if (result == NULL || iterations == 0)
+        return;
+
+    Cycle_Counter_Init();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint32_t k = 0; k < count; k++) {
+            uint32_t start = Cycle_Counter_Get();
+            float latF = NMEA_To_Decimal(samples[k][0]);
+            float lonF = NMEA_To_Decimal(samples[k][1]);
+            sink = GPS_CalcDistance(latF, lonF, checkLat, checkLon) < 5.0f;
+            sink = (int)Map_Float(lonF, NW_lon / 1e7f, SE_lon / 1e7f, 0.00f, MAP_X_SIZE);
+            floatTotal += Cycle_Counter_Get() - start;
+
+            int32_t lat, lon;
+            start = Cycle_Counter_Get();
+            NMEA_Parser_To_Coordinate(samples[k][0], "N", &lat);
+            NMEA_Parser_To_Coordinate(samples[k][1], "E", &lon);
+            sink = GPS_Distance_Squared(lat, lon, Checkpoints[0].lat, Checkpoints[0].lon)
+                   < (int64_t)CHECKPOINT_RADIUS_MM * CHECKPOINT_RADIUS_MM;
+            sink = Geo_To_Map(lon, NW_lon, SE_lon, MAP_X_SIZE);
+            fixedTotal += Cycle_Counter_Get() - start;
+
+            if (i == 0) {
+                double north = ((double)latF * 1e7 - lat) * GEO_MM_PER_UNIT_Q16 / 65536.0;
+                double east = ((double)lonF * 1e7 - lon) * GEO_MM_PER_UNIT_Q16 / 65536.0
+                              * GEO_COS_LAT_Q16 / 65536.0;
+                double error = sqrt(north * north + east * east);
+                if (error > worst)
+                    worst = error;
+            }
+        }
+    }
+    (void)sink;
+
+    result->floatCycles = floatTotal / (iterations * count);
+    result->fixedCycles = fixedTotal / (iterations * count);
+    result->floatErrorMm = (uint32_t)(worst + 0.5);
+}
+
+/**
+  * @brief  Former float coordinate parser, kept as the benchmark reference.
+  *         Parses NMEA coordinate string and converts it to decimal degrees.
+  *
+  *         Extracts degree and minute parts from the string, then returns
+  *         decimal representation (degrees + minutes/60).
+  *
+  * @param  nmea: NMEA coordinate string (e.g. "4916.45" or "12311.12").
+  * @retval Decimal degrees as float.
+  */
+static float NMEA_To_Decimal(const char *nmea)
+{
+    if (nmea == NULL) return 0.0f;
+
+    int degrees = 0;
+    float minutes = 0.0f;
+    char deg_buff[4] = {0};
+
+    int len = strchr(nmea, '.') - nmea;
+    int deg_digits = (len > 4) ? 3 : 2;
+
+    strncpy(deg_buff, nmea, deg_digits);
+    degrees = atoi(deg_buff);
+    minutes = atof(nmea + deg_digits);
+
+    return degrees + (minutes / 60.0f);
+}
+
+/**
+  * @brief  Former float distance, kept as the benchmark reference.
+  *         Computes distance in meters between two geographic coordinates.
+  *         Uses the Haversine formula accounting for earth's curvature.
+  *
+  * @param  lat1: Latitude of start point (degrees).
+  * @param  lon1: Longitude of start point (degrees).
+  * @param  lat2: Latitude of end point (degrees).
+  * @param  lon2: Longitude of end point (degrees).
+  *
+  * @retval Distance in meters.
+  */
+static float GPS_CalcDistance(float lat1, float lon1, float lat2, float lon2)
+{
+    const float R = 6371000.0f; // earth radius in meters
+    float dLat = (lat2 - lat1) * (M_PI / 180.0f);
+    float dLon = (lon2 - lon1) * (M_PI / 180.0f);
+
+    float a = sinf(dLat/2) * sinf(dLat/2) +
+              cosf(lat1 * M_PI / 180.0f) * cosf(lat2 * M_PI / 180.0f) *
+              sinf(dLon/2) * sinf(dLon/2);
+
+    float c = 2 * atan2f(sqrtf(a), sqrtf(1-a));
+    return R * c; // distance in meters
+}
+#endif // DASHBOARD_ENABLE_BENCHMARK
@@ -0,0 +1,427 @@
+/**
+ ******************************************************************************
+ * @file           : gps_config.c
+ * @brief          : UBX configuration messages with acknowledgment and fallback
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * A UBX frame is 0xB5 0x62, class, id, 16-bit little-endian length, payload
+ * and an 8-bit Fletcher checksum over class..payload. Commands are sent with
+ * a blocking transmit; the answer (ACK-ACK 0x05 0x01 or ACK-NAK 0x05 0x00,
+ * payload = class and id of the command) is picked out of the received
+ * stream, and the NMEA bytes around it are discarded.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "gps_config.h"
+#include "gps_rx.h"
+#include "nmea_parser.h"
+#include <string.h>
+
+/* Private Constants ---------------------------------------------------------*/
+
+#define UBX_SYNC_1 0xB5U
+#define UBX_SYNC_2 0x62U
+
+#define UBX_CLASS_ACK 0x05U
+#define UBX_ACK_NAK 0x00U
+#define UBX_ACK_ACK 0x01U
+
+#define UBX_CLASS_CFG 0x06U
+#define UBX_CFG_PRT 0x00U
+#define UBX_CFG_MSG 0x01U
+#define UBX_CFG_RATE 0x08U
+
+#define UBX_CLASS_NMEA 0xF0U      /*!< Class of the standard NMEA sentences in CFG-MSG */
+#define UBX_NMEA_GGA 0x00U
+#define UBX_NMEA_GLL 0x01U
+#define UBX_NMEA_GSA 0x02U
+#define UBX_NMEA_GSV 0x03U
+#define UBX_NMEA_RMC 0x04U
+#define UBX_NMEA_VTG 0x05U
+
+#define UBX_OVERHEAD 8U           /*!< Sync, class, id, length and checksum bytes */
+#define UBX_MAX_PAYLOAD 20U       /*!< CFG-PRT is the longest command sent */
+
+#define UBX_PRT_UART1 1U          /*!< Port id of the receiver UART */
+#define UBX_PRT_MODE_8N1 0x000008C0UL
+#define UBX_PROTO_UBX_NMEA 0x0003U
+
+#define UBX_TIME_GPS 1U           /*!< CFG-RATE time reference */
+
+#define GPS_DEFAULT_PERIOD_MS 1000U
+
+#define TX_TIMEOUT_MS 100U
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  UBX frame scanner states.
+  */
+typedef enum {
+    UBX_WAIT_SYNC_1 = 0,
+    UBX_WAIT_SYNC_2,
+    UBX_CLASS,
+    UBX_ID,
+    UBX_LENGTH_LOW,
+    UBX_LENGTH_HIGH,
+    UBX_PAYLOAD,
+    UBX_CHECKSUM_A,
+    UBX_CHECKSUM_B
+} UBX_State;
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief UART handle of the receiver during the configuration.
+ */
+static UART_HandleTypeDef *_uart = NULL;
+
+/**
+ * @brief Outcome reported through GPS_Config_Get_Result().
+ */
+static GPS_Config_Result _result = {0};
+
+/**
+ * @brief NMEA sentences and their output rate (per epoch, 0 = off).
+ *        The first entry doubles as the probe that finds the receiver.
+ */
+static const uint8_t _sentenceRates[][2] = {
+    {UBX_NMEA_GLL, 0U},
+    {UBX_NMEA_GSV, 0U},
+    {UBX_NMEA_RMC, 1U},
+    {UBX_NMEA_VTG, 1U},
+    {UBX_NMEA_GGA, 1U},
+    {UBX_NMEA_GSA, 1U}
+};
+
+static UBX_State _state = UBX_WAIT_SYNC_1;
+static uint8_t _frame[4];       /*!< Class, id and the first two payload bytes */
+static uint16_t _length = 0;    /*!< Payload length of the frame being scanned */
+static uint16_t _received = 0;  /*!< Payload bytes scanned */
+static uint8_t _checkA = 0;     /*!< Running Fletcher checksum */
+static uint8_t _checkB = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Gps_Config_Private_Functions
+  * @{
+  */
+static HAL_StatusTypeDef Command(uint8_t id, const uint8_t *payload, uint16_t length, uint32_t timeout);
+static HAL_StatusTypeDef Send_Frame(uint8_t msgClass, uint8_t id, const uint8_t *payload, uint16_t length);
+static HAL_StatusTypeDef Wait_Ack(uint8_t id, uint32_t timeout);
+static uint8_t Scan_Byte(uint8_t byte);
+static HAL_StatusTypeDef Set_Sentence_Rate(uint8_t index, uint32_t timeout);
+static HAL_StatusTypeDef Send_Port(uint32_t baudRate);
+static HAL_StatusTypeDef Switch_Baud(uint32_t baudRate);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Configures the receiver output and the link rate.
+  *
+  *         1. Probe: GLL off, at the current rate, then at baudRate.
+  *         2. CFG-PRT to baudRate, UART switch, probe again (GSV off). On
+  *            silence CFG-PRT back to the original rate is sent at the new
+  *            rate, and the UART returns to the original rate.
+  *         3. RMC, VTG, GGA and GSA on.
+  *         4. CFG-RATE to periodMs, only at baudRate: at 9600 baud a
+  *            10 Hz output would not fit the line.
+  *
+  * @param  uart:     UART handle of the GPS module.
+  * @param  baudRate: Link rate to switch to.
+  * @param  periodMs: Navigation period.
+  * @param  timeout:  Wait for each acknowledgment in ms.
+  * @retval HAL_OK, HAL_ERROR or HAL_TIMEOUT, see gps_config.h.
+  */
+HAL_StatusTypeDef GPS_Config_Apply(UART_HandleTypeDef *uart, uint32_t baudRate, uint16_t periodMs, uint32_t timeout)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+    uint8_t next = 1;       // First _sentenceRates entry not yet sent
+
+    if (uart == NULL || baudRate == 0 || periodMs == 0)
+        return HAL_ERROR;
+
+    _uart = uart;
+    memset(&_result, 0, sizeof(_result));
+    _result.periodMs = GPS_DEFAULT_PERIOD_MS;
+
+    uint32_t original = _uart->Init.BaudRate;
+
+    // 1. Find the receiver: at the boot rate, or still at baudRate after an MCU-only reset
+    if (Set_Sentence_Rate(0, timeout) != HAL_OK) {
+        if (original == baudRate || Switch_Baud(baudRate) != HAL_OK
+            || Set_Sentence_Rate(0, timeout) != HAL_OK) {
+            Switch_Baud(original);
+            _result.baudRate = _uart->Init.BaudRate;
+            NMEA_Parser_Reset();
+            return HAL_TIMEOUT;
+        }
+    }
+
+    // 2. Faster link; the CFG-PRT acknowledgment is sent while the port changes, so it is not waited for
+    if (_uart->Init.BaudRate != baudRate) {
+        if (Send_Port(baudRate) != HAL_OK)
+            status = HAL_ERROR;
+
+        HAL_Delay(GPS_CONFIG_SWITCH_DELAY_MS);
+        if (status != HAL_OK || Switch_Baud(baudRate) != HAL_OK
+            || Set_Sentence_Rate(1, timeout) != HAL_OK) {
+            Send_Port(original);            // In case the receiver did switch
+            HAL_Delay(GPS_CONFIG_SWITCH_DELAY_MS);
+            Switch_Baud(original);
+            status = HAL_ERROR;
+        } else {
+            next = 2;
+        }
+    }
+
+    // 3. Sentence selection
+    for (uint8_t i = next; i < sizeof(_sentenceRates) / sizeof(_sentenceRates[0]); i++) {
+        if (Set_Sentence_Rate(i, timeout) != HAL_OK)
+            status = HAL_ERROR;
+    }
+
+    // 4. Navigation rate, only where the link can carry it
+    if (_uart->Init.BaudRate == baudRate) {
+        uint8_t rate[6] = {
+            (uint8_t)periodMs, (uint8_t)(periodMs >> 8),   // measRate
+            1U, 0U,                                         // navRate: every measurement
+            UBX_TIME_GPS, 0U                                // timeRef
+        };
+
+        if (Command(UBX_CFG_RATE, rate, sizeof(rate), timeout) == HAL_OK)
+            _result.periodMs = periodMs;
+        else
+            status = HAL_ERROR;
+    }
+
+    _result.baudRate = _uart->Init.BaudRate;
+    NMEA_Parser_Reset();    // The parser may hold a sentence cut by the skipped bytes
+    return status;
+}
+
+/**
+  * @brief  Copies the outcome of the last configuration.
+  * @param  result: Destination structure.
+  * @retval None
+  */
+void GPS_Config_Get_Result(GPS_Config_Result *result)
+{
+    if (result != NULL)
+        *result = _result;
+}
+
+/**
+  * @brief  Sends a CFG command and waits for its acknowledgment.
+  * @param  id:      CFG message id.
+  * @param  payload: Command payload.
+  * @param  length:  Payload length.
+  * @param  timeout: Wait in ms.
+  * @retval HAL_OK on ACK-ACK, HAL_ERROR on ACK-NAK or a failed transmit,
+  *         HAL_TIMEOUT without an answer.
+  */
+static HAL_StatusTypeDef Command(uint8_t id, const uint8_t *payload, uint16_t length, uint32_t timeout)
+{
+    HAL_StatusTypeDef status = Send_Frame(UBX_CLASS_CFG, id, payload, length);
+
+    if (status == HAL_OK)
+        status = Wait_Ack(id, timeout);
+
+    if (status == HAL_OK)
+        _result.acknowledged++;
+    else if (status == HAL_TIMEOUT)
+        _result.unanswered++;
+    else
+        _result.rejected++;
+
+    return status;
+}
+
+/**
+  * @brief  Builds a UBX frame and transmits it.
+  * @param  msgClass: Message class.
+  * @param  id:       Message id.
+  * @param  payload:  Payload bytes.
+  * @param  length:   Payload length, at most UBX_MAX_PAYLOAD.
+  * @retval HAL status of the transmission.
+  */
+static HAL_StatusTypeDef Send_Frame(uint8_t msgClass, uint8_t id, const uint8_t *payload, uint16_t length)
+{
+    uint8_t frame[UBX_MAX_PAYLOAD + UBX_OVERHEAD];
+    uint8_t a = 0, b = 0;
+
+    if (length > UBX_MAX_PAYLOAD)
+        return HAL_ERROR;
+
+    frame[0] = UBX_SYNC_1;
+    frame[1] = UBX_SYNC_2;
+    frame[2] = msgClass;
+    frame[3] = id;
+    frame[4] = (uint8_t)length;
+    frame[5] = (uint8_t)(length >> 8);
+    memcpy(&frame[6], payload, length);
+
+    for (uint16_t i = 2; i < 6U + length; i++) {
+        a += frame[i];
+        b += a;
+    }
+    frame[6 + length] = a;
+    frame[7 + length] = b;
+
+    return HAL_UART_Transmit(_uart, frame, length + UBX_OVERHEAD, TX_TIMEOUT_MS);
+}
+
+/**
+  * @brief  Reads the received stream until the answer to a CFG command.
+  * @param  id:      CFG message id the answer must refer to.
+  * @param  timeout: Wait in ms.
+  * @retval HAL_OK on ACK-ACK, HAL_ERROR on ACK-NAK, HAL_TIMEOUT otherwise.
+  */
+static HAL_StatusTypeDef Wait_Ack(uint8_t id, uint32_t timeout)
+{
+    uint32_t start = HAL_GetTick();
+    const uint8_t *data;
+    uint16_t length;
+
+    _state = UBX_WAIT_SYNC_1;
+
+    do {
+        while ((length = GPS_Rx_Read(&data)) != 0) {
+            for (uint16_t i = 0; i < length; i++) {
+                if (Scan_Byte(data[i]) && _frame[0] == UBX_CLASS_ACK && _length == 2U
+                    && _frame[2] == UBX_CLASS_CFG && _frame[3] == id)
+                    return (_frame[1] == UBX_ACK_ACK) ? HAL_OK : HAL_ERROR;
+            }
+        }
+    } while (HAL_GetTick() - start < timeout);
+
+    return HAL_TIMEOUT;
+}
+
+/**
+  * @brief  Advances the UBX frame scanner by one byte.
+  * @param  byte: Received byte.
+  * @retval 1 when a frame with a valid checksum ends with this byte, 0 otherwise.
+  */
+static uint8_t Scan_Byte(uint8_t byte)
+{
+    switch (_state) {
+    case UBX_WAIT_SYNC_1:
+        if (byte == UBX_SYNC_1)
+            _state = UBX_WAIT_SYNC_2;
+        return 0;
+
+    case UBX_WAIT_SYNC_2:
+        _state = (byte == UBX_SYNC_2) ? UBX_CLASS : UBX_WAIT_SYNC_1;
+        _checkA = 0;
+        _checkB = 0;
+        return 0;
+
+    case UBX_CHECKSUM_A:
+        _state = (byte == _checkA) ? UBX_CHECKSUM_B : UBX_WAIT_SYNC_1;
+        return 0;
+
+    case UBX_CHECKSUM_B:
+        _state = UBX_WAIT_SYNC_1;
+        return (byte == _checkB) ? 1U : 0U;
+
+    default:
+        break;
+    }
+
+    _checkA += byte;
+    _checkB += _checkA;
+
+    switch (_state) {
+    case UBX_CLASS:
+        _frame[0] = byte;
+        _state = UBX_ID;
+        break;
+    case UBX_ID:
+        _frame[1] = byte;
+        _state = UBX_LENGTH_LOW;
+        break;
+    case UBX_LENGTH_LOW:
+        _length = byte;
+        _state = UBX_LENGTH_HIGH;
+        break;
+    case UBX_LENGTH_HIGH:
+        _length |= (uint16_t)byte << 8;
+        _received = 0;
+        _state = (_length == 0) ? UBX_CHECKSUM_A : UBX_PAYLOAD;
+        break;
+    case UBX_PAYLOAD:
+        if (_received < 2U)
+            _frame[2 + _received] = byte;
+        if (++_received == _length)
+            _state = UBX_CHECKSUM_A;
+        break;
+    default:
+        _state = UBX_WAIT_SYNC_1;
+        break;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  Sends the CFG-MSG command of one _sentenceRates entry.
+  * @param  index:   Entry index.
+  * @param  timeout: Wait in ms.
+  * @retval Result of Command().
+  */
+static HAL_StatusTypeDef Set_Sentence_Rate(uint8_t index, uint32_t timeout)
+{
+    uint8_t message[3] = {UBX_CLASS_NMEA, _sentenceRates[index][0], _sentenceRates[index][1]};
+
+    return Command(UBX_CFG_MSG, message, sizeof(message), timeout);
+}
+
+/**
+  * @brief  Sends CFG-PRT for the receiver UART: 8N1, UBX and NMEA in and out.
+  * @param  baudRate: New rate of the receiver UART.
+  * @retval HAL status of the transmission.
+  */
+static HAL_StatusTypeDef Send_Port(uint32_t baudRate)
+{
+    uint8_t port[20] = {0};
+
+    port[0] = UBX_PRT_UART1;
+    port[4] = (uint8_t)UBX_PRT_MODE_8N1;
+    port[5] = (uint8_t)(UBX_PRT_MODE_8N1 >> 8);
+    port[8] = (uint8_t)baudRate;
+    port[9] = (uint8_t)(baudRate >> 8);
+    port[10] = (uint8_t)(baudRate >> 16);
+    port[11] = (uint8_t)(baudRate >> 24);
+    port[12] = (uint8_t)UBX_PROTO_UBX_NMEA;   // inProtoMask
+    port[14] = (uint8_t)UBX_PROTO_UBX_NMEA;   // outProtoMask
+
+    return Send_Frame(UBX_CLASS_CFG, UBX_CFG_PRT, port, sizeof(port));
+}
+
+/**
+  * @brief  Moves the UART to a new rate and restarts the reception.
+  * @param  baudRate: New baud rate.
+  * @retval HAL_OK if the UART was re-initialized, HAL_ERROR otherwise.
+  */
+static HAL_StatusTypeDef Switch_Baud(uint32_t baudRate)
+{
+    GPS_Rx_Stop();
+    _uart->Init.BaudRate = baudRate;
+    if (HAL_UART_Init(_uart) != HAL_OK)
+        return HAL_ERROR;
+
+    return GPS_Rx_Start();
+}
@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ * @file           : gps_rx.c
+ * @brief          : Circular DMA reception of the GPS data stream
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * The interrupt side only advances a running byte count from the DMA write
+ * position. The main loop compares it with its own read count: the
+ * difference is what is waiting, and a difference larger than the buffer
+ * means the DMA has lapped the reader. The waiting bytes are handed out in
+ * place, in at most two chunks when they wrap around the end of the buffer;
+ * framing is left to the NMEA parser (nmea_parser.h).
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "gps_rx.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief UART handle the receiver is bound to.
+ */
+static UART_HandleTypeDef *_uart = NULL;
+
+/**
+ * @brief Circular DMA buffer.
+ */
+static uint8_t _buffer[GPS_RX_BUFFER_SIZE];
+
+static uint16_t _dmaPosition = 0;       /*!< DMA write position at the last event */
+static volatile uint32_t _written = 0;  /*!< Bytes written by the DMA since the start */
+static uint32_t _read = 0;              /*!< Bytes consumed by GPS_Rx_Read() */
+
+static uint8_t _resync = 0;             /*!< 1 after an overrun until the next '$' */
+
+/**
+ * @brief Receiver counters reported through GPS_Rx_Get_Stats().
+ */
+static GPS_Rx_Stats _stats = {0};
+
+
+/**
+  * @brief  Binds the UART handle and starts the reception.
+  * @param  uart: UART handle of the GPS module.
+  * @retval HAL_OK on success, HAL_ERROR on a NULL handle or a failed start.
+  */
+HAL_StatusTypeDef GPS_Rx_Init(UART_HandleTypeDef *uart)
+{
+    if (uart == NULL)
+        return HAL_ERROR;
+
+    _uart = uart;
+    memset(&_stats, 0, sizeof(_stats));
+
+    return GPS_Rx_Start();
+}
+
+/**
+  * @brief  Resets the framing and starts the circular reception.
+  * @retval HAL status of the reception request.
+  */
+HAL_StatusTypeDef GPS_Rx_Start(void)
+{
+    if (_uart == NULL)
+        return HAL_ERROR;
+
+    _dmaPosition = 0;
+    _written = 0;
+    _read = 0;
+    _resync = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(_uart, _buffer, GPS_RX_BUFFER_SIZE);
+}
+
+/**
+  * @brief  Aborts the reception.
+  * @retval None
+  */
+void GPS_Rx_Stop(void)
+{
+    if (_uart != NULL)
+        HAL_UART_AbortReceive(_uart);
+}
+
+/**
+  * @brief  Returns the next run of received bytes without copying them.
+  *
+  *         After an overrun the bytes up to the next '$' are skipped, so the
+  *         parser never joins the start of one sentence with the end of
+  *         another.
+  *
+  * @param  data: Receives a pointer to the first byte in the DMA buffer.
+  * @retval Number of bytes at data, 0 when everything has been read.
+  */
+uint16_t GPS_Rx_Read(const uint8_t **data)
+{
+    uint32_t written = _written;
+
+    if (data == NULL)
+        return 0;
+
+    if (written - _read > GPS_RX_BUFFER_SIZE) {
+        _stats.overruns++;      // Unread data was overwritten; resynchronise on the next '$'
+        _read = written;
+        _resync = 1;
+    }
+
+    while (_resync && _read != written) {
+        if (_buffer[_read % GPS_RX_BUFFER_SIZE] == '$')
+            _resync = 0;
+        else
+            _read++;
+    }
+
+    uint16_t start = _read % GPS_RX_BUFFER_SIZE;
+    uint32_t length = written - _read;
+
+    if (length > GPS_RX_BUFFER_SIZE - start)
+        length = GPS_RX_BUFFER_SIZE - start;    // Up to the end of the buffer; the rest on the next call
+
+    *data = &_buffer[start];
+    _read += length;
+    return (uint16_t)length;
+}
+
+/**
+  * @brief  Copies the receiver counters.
+  * @param  stats: Destination structure.
+  * @retval None
+  */
+void GPS_Rx_Get_Stats(GPS_Rx_Stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    *stats = _stats;
+    stats->bytes = _written;
+}
+
+/**
+  * @brief  Publishes the bytes received since the last event.
+  *
+  *         Called on IDLE line, half transfer and transfer complete. size is
+  *         the DMA write position (GPS_RX_BUFFER_SIZE at the wrap).
+  *
+  * @param  huart: UART handle reporting the event.
+  * @param  size:  DMA write position.
+  * @retval None
+  */
+void GPS_Rx_Event_Callback(UART_HandleTypeDef *huart, uint16_t size)
+{
+    if (huart != _uart)
+        return;
+
+    uint16_t end = size % GPS_RX_BUFFER_SIZE;
+
+    _written += (uint16_t)(end - _dmaPosition) % GPS_RX_BUFFER_SIZE;
+    _dmaPosition = end;
+}
+
+/**
+  * @brief  Restarts the reception once HAL has aborted it after an error.
+  * @param  huart: UART handle reporting the error.
+  * @retval None
+  */
+void GPS_Rx_Error_Callback(UART_HandleTypeDef *huart)
+{
+    if (huart != _uart || huart->RxState != HAL_UART_STATE_READY)
+        return;
+
+    _stats.restarts++;
+    GPS_Rx_Start();
+}
@@ -0,0 +1,244 @@
+/**
+ ******************************************************************************
+ * @file           : map_trail.c
+ * @brief          : Online distance / angle simplification of the driven path
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * The vertices live in a ring buffer. The newest vertex is the live tip: it
+ * follows the vehicle as long as the path stays straight, and is frozen as
+ * soon as the direction changes by more than the tolerance. This is the
+ * one-pass equivalent of a Douglas-Peucker simplification with an angular
+ * tolerance; it needs no point history and runs in constant time.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "map_trail.h"
+#include <string.h>
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+#include "cycle_counter.h"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Ring buffer of vertices.
+ */
+static Map_Trail_Point _points[MAP_TRAIL_MAX_POINTS];
+static uint8_t _first = 0;      /*!< Index of the oldest vertex */
+static uint8_t _count = 0;      /*!< Number of vertices */
+
+/**
+ * @brief Decimation counters reported through Map_Trail_Get_Stats().
+ */
+static Map_Trail_Stats _stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Map_Trail_Private_Functions
+  * @{
+  */
+static Map_Trail_Point *Vertex(uint8_t index);
+static void Push_Vertex(int16_t x, int16_t y);
+static int16_t Clamp(int value);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Clears all vertices and counters.
+  * @retval None
+  */
+void Map_Trail_Reset(void)
+{
+    _first = 0;
+    _count = 0;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+  * @brief  Adds a position and simplifies the polyline on the fly.
+  *
+  *         With A the last frozen vertex, C the live tip and P the new
+  *         position, the tip moves to P when A-C-P is straight enough:
+  *
+  *           (C-A) x (P-C)  squared  <=  sin^2(tol) * |C-A|^2 * |P-C|^2
+  *           (C-A) . (P-C)  >  0      (no U-turn)
+  *
+  * @param  x: Map pixel X, clamped to +-MAP_TRAIL_LIMIT.
+  * @param  y: Map pixel Y, clamped to +-MAP_TRAIL_LIMIT.
+  * @retval 1 if the polyline changed, 0 otherwise.
+  */
+uint8_t Map_Trail_Add(int x, int y)
+{
+    int16_t px = Clamp(x);      // Far off the map, e.g. a fix before the track is reached
+    int16_t py = Clamp(y);
+
+    _stats.points++;
+
+    if (_count == 0) {
+        Push_Vertex(px, py);
+        _stats.vertices++;
+        return 1;
+    }
+
+    Map_Trail_Point *tip = Vertex(_count - 1U);
+    int32_t dx = px - tip->x;
+    int32_t dy = py - tip->y;
+    int64_t step2 = (int64_t)dx * dx + (int64_t)dy * dy;
+
+    if (step2 < (int64_t)MAP_TRAIL_MIN_DISTANCE * MAP_TRAIL_MIN_DISTANCE) {
+        _stats.ignored++;
+        return 0;
+    }
+
+    if (_count >= 2U) {
+        Map_Trail_Point *anchor = Vertex(_count - 2U);
+        int32_t ax = tip->x - anchor->x;
+        int32_t ay = tip->y - anchor->y;
+        int64_t cross = (int64_t)ax * dy - (int64_t)ay * dx;
+        int64_t dot = (int64_t)ax * dx + (int64_t)ay * dy;
+        int64_t segment2 = (int64_t)ax * ax + (int64_t)ay * ay;
+
+        // Clamped positions give steps up to 2^12 pixels: cross^2 < 2^51, and
+        // segment2 * step2 * sin^2 (Q16) < 2^61 before it is scaled back
+        if (dot > 0 && cross * cross <= (segment2 * step2 * MAP_TRAIL_SIN2_Q16) >> 16) {
+            tip->x = px;      // Still straight: extend the last segment
+            tip->y = py;
+            _stats.merged++;
+            return 1;
+        }
+    }
+
+    Push_Vertex(px, py);
+    _stats.vertices++;
+    return 1;
+}
+
+/**
+  * @brief  Returns the number of vertices.
+  * @retval Vertex count.
+  */
+uint8_t Map_Trail_Get_Count(void)
+{
+    return _count;
+}
+
+/**
+  * @brief  Returns a vertex, oldest first.
+  * @param  index: Vertex index.
+  * @retval Vertex, or (0, 0) for an index out of range.
+  */
+Map_Trail_Point Map_Trail_Get_Point(uint8_t index)
+{
+    Map_Trail_Point none = {0, 0};
+
+    return (index < _count) ? *Vertex(index) : none;
+}
+
+/**
+  * @brief  Copies the decimation counters.
+  * @param  stats: Destination structure.
+  * @retval None
+  */
+void Map_Trail_Get_Stats(Map_Trail_Stats *stats)
+{
+    if (stats != NULL)
+        *stats = _stats;
+}
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+  * @brief  Feeds a synthetic lap and measures the cost per position.
+  *
+  *         The path is a 300 x 200 pixel rectangle with rounded corners,
+  *         walked in 2 pixel steps with +-1 pixel jitter, which exercises the
+  *         ignore, merge and new-vertex paths.
+  *
+  * @param  points: Number of positions.
+  * @retval Average CPU cycles per position, 0 if points is 0.
+  */
+uint32_t Map_Trail_Benchmark(uint32_t points)
+{
+    uint32_t total = 0;
+    int x = 100, y = 100, dx = 2, dy = 0;
+
+    if (points == 0)
+        return 0;
+
+    Map_Trail_Reset();
+    Cycle_Counter_Init();
+
+    for (uint32_t i = 0; i < points; i++) {
+        int jitter = (int)((i * 7U) % 3U) - 1;
+
+        x += dx;
+        y += dy;
+        if (x >= 400 && dx > 0) { dx = 0; dy = 2; }
+        if (y >= 300 && dy > 0) { dx = -2; dy = 0; }
+        if (x <= 100 && dx < 0) { dx = 0; dy = -2; }
+        if (y <= 100 && dy < 0) { dx = 2; dy = 0; }
+
+        uint32_t start = Cycle_Counter_Get();
+        Map_Trail_Add(x + jitter, y - jitter);
+        total += Cycle_Counter_Get() - start;
+    }
+
+    Map_Trail_Reset();
+    return total / points;
+}
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Returns a pointer to vertex index of the ring.
+  * @param  index: Vertex index, 0 = oldest.
+  * @retval Pointer into the ring buffer.
+  */
+static Map_Trail_Point *Vertex(uint8_t index)
+{
+    return &_points[(_first + index) % MAP_TRAIL_MAX_POINTS];
+}
+
+/**
+  * @brief  Appends a vertex, dropping the oldest one when the ring is full.
+  * @param  x: Map pixel X.
+  * @param  y: Map pixel Y.
+  * @retval None
+  */
+static void Push_Vertex(int16_t x, int16_t y)
+{
+    if (_count == MAP_TRAIL_MAX_POINTS) {
+        _first = (_first + 1U) % MAP_TRAIL_MAX_POINTS;
+        _count--;
+    }
+
+    Map_Trail_Point *vertex = Vertex(_count);
+    vertex->x = x;
+    vertex->y = y;
+    _count++;
+}
+
+/**
+  * @brief  Limits a map pixel coordinate to +-MAP_TRAIL_LIMIT.
+  * @param  value: Map pixel coordinate.
+  * @retval Clamped coordinate.
+  */
+static int16_t Clamp(int value)
+{
+    if (value < -MAP_TRAIL_LIMIT)
+        return -MAP_TRAIL_LIMIT;
+    if (value > MAP_TRAIL_LIMIT)
+        return MAP_TRAIL_LIMIT;
+    return (int16_t)value;
+}
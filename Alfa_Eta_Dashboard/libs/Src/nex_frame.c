@@ -0,0 +1,468 @@
+/**
+ ******************************************************************************
+ * @file           : nex_frame.c
+ * @brief          : Contiguous frame buffer for batched Nextion commands
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * Commands are appended back to back into a static buffer together with
+ * their 0xFF 0xFF 0xFF terminators. Committing the frame performs a single
+ * NEX_Link_Write(), so a refresh costs one queue operation and one DMA
+ * transfer instead of two blocking UART calls per widget.
+ *
+ * Numeric values are converted two digits at a time from a 200-byte lookup
+ * table, so a 4-digit value costs two divisions by 100 (compiled to a multiply)
+ * instead of a full vfprintf() format parse.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nex_frame.h"
+#include <string.h>
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+#include "cycle_counter.h"
+#include <stdio.h>
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Frame storage.
+ */
+static uint8_t _frame[NEX_FRAME_BUFFER_SIZE];
+
+static uint16_t _length = 0;     /*!< Bytes used in the open frame */
+static uint16_t _capacity = 0;   /*!< Bytes usable in the open frame */
+static uint16_t _commands = 0;   /*!< Commands in the open frame */
+static const char *_close = NULL; /*!< Closing command of a wrapped frame, NULL if not wrapped */
+static uint16_t _opening = 0;    /*!< Bytes of the opening command of a wrapped frame */
+
+/**
+ * @brief Size information reported through NEX_Frame_Get_Info().
+ */
+static NEX_FrameInfo _info = {0};
+
+/**
+ * @brief Nextion command terminator: 3-byte sequence required to mark end of commands.
+ */
+static const uint8_t COMMAND_END[3] = {0xFF, 0xFF, 0xFF};
+
+/**
+ * @brief ASCII digit pairs "00".."99" used by the integer encoder.
+ */
+static const char DIGIT_PAIRS[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Private Constants ---------------------------------------------------------*/
+
+#define INT_MAX_DIGITS 11U   /*!< "-2147483648" */
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Nex_Frame_Private_Functions
+  * @{
+  */
+static uint8_t Int_To_Ascii(int32_t value, char *end);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Opens an empty frame sized to what the TX queue can accept.
+  * @retval None
+  */
+void NEX_Frame_Begin(void)
+{
+    NEX_Frame_Begin_Budget(NEX_FRAME_BUFFER_SIZE);
+}
+
+/**
+  * @brief  Opens an empty frame of at most budget bytes.
+  * @param  budget: Byte budget of the frame.
+  * @retval None
+  */
+void NEX_Frame_Begin_Budget(uint16_t budget)
+{
+    uint16_t free = NEX_Link_Get_Free();
+
+    _length = 0;
+    _commands = 0;
+    _close = NULL;
+    _capacity = (free < NEX_FRAME_BUFFER_SIZE) ? free : NEX_FRAME_BUFFER_SIZE;
+    if (budget < _capacity)
+        _capacity = budget;
+}
+
+/**
+  * @brief  Appends the opening command and keeps room for the closing one.
+  * @param  open:  Opening command.
+  * @param  close: Closing command, appended by NEX_Frame_Commit().
+  * @retval HAL_OK if wrapped, HAL_ERROR if the frame is not empty or too small.
+  */
+HAL_StatusTypeDef NEX_Frame_Wrap(const char *open, const char *close)
+{
+    uint16_t reserve = strlen(close) + sizeof(COMMAND_END);
+
+    if (_length != 0 || _capacity < reserve)
+        return HAL_ERROR;
+
+    _capacity -= reserve;
+    if (NEX_Frame_Append(open) != HAL_OK) {
+        _capacity += reserve;
+        return HAL_ERROR;
+    }
+
+    _close = close;
+    _opening = _length;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Copies a command and the Nextion terminator into the open frame.
+  * @param  cmd: Null-terminated command string.
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+HAL_StatusTypeDef NEX_Frame_Append(const char *cmd)
+{
+    size_t len = strlen(cmd);
+
+    if (_length + len + sizeof(COMMAND_END) > _capacity)
+        return HAL_ERROR;
+
+    memcpy(&_frame[_length], cmd, len);
+    _length += len;
+    memcpy(&_frame[_length], COMMAND_END, sizeof(COMMAND_END));
+    _length += sizeof(COMMAND_END);
+    _commands++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Appends a numeric command built from a constant prefix and a value.
+  *
+  *         The digits are produced first into a small scratch buffer so the
+  *         exact command length is known before touching the frame.
+  *
+  * @param  prefix: Constant command prefix, e.g. NEX_PREFIX("nSd.val=").
+  * @param  value:  Signed value written in decimal (negative for pMap.y).
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Int(const NEX_Prefix *prefix, int32_t value)
+{
+    char digits[INT_MAX_DIGITS];
+    uint8_t count = Int_To_Ascii(value, digits + sizeof(digits));
+
+    if (_length + prefix->length + count + sizeof(COMMAND_END) > _capacity)
+        return HAL_ERROR;
+
+    memcpy(&_frame[_length], prefix->text, prefix->length);
+    _length += prefix->length;
+    memcpy(&_frame[_length], digits + sizeof(digits) - count, count);
+    _length += count;
+    memcpy(&_frame[_length], COMMAND_END, sizeof(COMMAND_END));
+    _length += sizeof(COMMAND_END);
+    _commands++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Appends a command with several numeric arguments, e.g. "addt 1,0,12".
+  * @param  prefix: Constant command prefix.
+  * @param  values: Arguments.
+  * @param  count:  Number of arguments.
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Ints(const NEX_Prefix *prefix, const int32_t *values, uint8_t count)
+{
+    char digits[INT_MAX_DIGITS];
+    uint16_t length = _length + prefix->length;
+
+    if (count == 0 || length > _capacity)
+        return HAL_ERROR;
+
+    memcpy(&_frame[_length], prefix->text, prefix->length);
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t n = Int_To_Ascii(values[i], digits + sizeof(digits));
+
+        if (length + n + 1U + sizeof(COMMAND_END) > _capacity)
+            return HAL_ERROR;   // _length untouched: the partial command is discarded
+
+        if (i > 0)
+            _frame[length++] = ',';
+        memcpy(&_frame[length], digits + sizeof(digits) - n, n);
+        length += n;
+    }
+
+    memcpy(&_frame[length], COMMAND_END, sizeof(COMMAND_END));
+    _length = length + sizeof(COMMAND_END);
+    _commands++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Appends a quoted, escaped text command.
+  *
+  *         The size is computed first so that a command that does not fit
+  *         leaves the frame untouched.
+  *
+  * @param  prefix: Constant command prefix.
+  * @param  text:   Null-terminated text.
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Text(const NEX_Prefix *prefix, const char *text)
+{
+    if (_length + NEX_Frame_Text_Size(prefix, text) > _capacity)
+        return HAL_ERROR;
+
+    memcpy(&_frame[_length], prefix->text, prefix->length);
+    _length += prefix->length;
+    _frame[_length++] = '"';
+
+    for (uint16_t i = 0; i < NEX_TEXT_MAX_LENGTH && text[i] != '\0'; i++) {
+        char c = text[i];
+
+        if ((uint8_t)c == 0xFFU || c == '\r')
+            continue;                       // Would end the command / line break is '\n'
+        if (c == '"' || c == '\\') {
+            _frame[_length++] = '\\';
+        } else if (c == '\n') {
+            _frame[_length++] = '\\';
+            c = 'r';
+        }
+        _frame[_length++] = (uint8_t)c;
+    }
+
+    _frame[_length++] = '"';
+    memcpy(&_frame[_length], COMMAND_END, sizeof(COMMAND_END));
+    _length += sizeof(COMMAND_END);
+    _commands++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Computes the size of a text command after escaping.
+  * @param  prefix: Constant command prefix.
+  * @param  text:   Null-terminated text.
+  * @retval Prefix, quotes, escaped text and terminator in bytes.
+  */
+uint16_t NEX_Frame_Text_Size(const NEX_Prefix *prefix, const char *text)
+{
+    uint16_t size = prefix->length + 2U + sizeof(COMMAND_END);
+
+    for (uint16_t i = 0; i < NEX_TEXT_MAX_LENGTH && text[i] != '\0'; i++) {
+        char c = text[i];
+
+        if ((uint8_t)c == 0xFFU || c == '\r')
+            continue;
+        size += (c == '"' || c == '\\' || c == '\n') ? 2U : 1U;
+    }
+    return size;
+}
+
+/**
+  * @brief  Copies raw bytes into the open frame.
+  * @param  data: Bytes to append.
+  * @param  len:  Number of bytes.
+  * @retval HAL_OK if appended, HAL_ERROR if it does not fit.
+  */
+HAL_StatusTypeDef NEX_Frame_Append_Bytes(const uint8_t *data, uint16_t len)
+{
+    if (_length + len > _capacity)
+        return HAL_ERROR;
+
+    memcpy(&_frame[_length], data, len);
+    _length += len;
+    _commands++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Computes the size of a numeric command without building it.
+  * @param  prefix: Constant command prefix.
+  * @param  value:  Value written in decimal.
+  * @retval Prefix, digits and terminator in bytes.
+  */
+uint16_t NEX_Frame_Int_Size(const NEX_Prefix *prefix, int32_t value)
+{
+    char digits[INT_MAX_DIGITS];
+
+    return prefix->length + Int_To_Ascii(value, digits + sizeof(digits)) + sizeof(COMMAND_END);
+}
+
+/**
+  * @brief  Computes the size of a multi-argument command without building it.
+  * @param  prefix: Constant command prefix.
+  * @param  values: Arguments.
+  * @param  count:  Number of arguments.
+  * @retval Prefix, arguments, separators and terminator in bytes.
+  */
+uint16_t NEX_Frame_Ints_Size(const NEX_Prefix *prefix, const int32_t *values, uint8_t count)
+{
+    char digits[INT_MAX_DIGITS];
+    uint16_t size = prefix->length + sizeof(COMMAND_END);
+
+    for (uint8_t i = 0; i < count; i++)
+        size += Int_To_Ascii(values[i], digits + sizeof(digits)) + ((i > 0) ? 1U : 0U);
+
+    return size;
+}
+
+/**
+  * @brief  Queues the open frame as one block and records its size.
+  * @retval HAL_OK if queued or empty, HAL_ERROR if the TX queue rejected it.
+  * @note   The frame is closed afterwards; call NEX_Frame_Begin() again
+  *         before appending further commands.
+  */
+HAL_StatusTypeDef NEX_Frame_Commit(void)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    if (_close != NULL) {
+        if (_length == _opening) {
+            _length = 0;            // Nothing between the wrapping commands
+        } else {
+            _capacity += strlen(_close) + sizeof(COMMAND_END);
+            NEX_Frame_Append(_close);
+        }
+        _close = NULL;
+    }
+
+    if (_length > 0) {
+        status = NEX_Link_Write(_frame, _length);
+        if (status == HAL_OK) {
+            _info.size = _length;
+            _info.commands = _commands;
+            if (_length > _info.peakSize)
+                _info.peakSize = _length;
+            _info.frames++;
+        }
+    }
+
+    _length = 0;
+    _commands = 0;
+    _capacity = 0;
+    return status;
+}
+
+/**
+  * @brief  Returns the number of bytes appended to the open frame so far.
+  */
+uint16_t NEX_Frame_Get_Size(void)
+{
+    return _length;
+}
+
+/**
+  * @brief  Returns the bytes still available in the open frame.
+  */
+uint16_t NEX_Frame_Get_Free(void)
+{
+    return (_capacity > _length) ? _capacity - _length : 0U;
+}
+
+/**
+  * @brief  Copies the size information of committed frames.
+  * @param  info: Destination structure.
+  */
+void NEX_Frame_Get_Info(NEX_FrameInfo *info)
+{
+    if (info != NULL)
+        *info = _info;
+}
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+  * @brief  Compares the snprintf() path with NEX_Frame_Append_Int().
+  *
+  *         Both paths encode the speed command into a freshly opened frame,
+  *         so the measurement covers formatting plus the copy into the frame.
+  *
+  * @param  value:      Value to encode.
+  * @param  iterations: Number of encodes per path.
+  * @param  result:     Average CPU cycles per command for each path.
+  * @retval None
+  */
+void NEX_Frame_Benchmark_Int(int32_t value, uint32_t iterations, NEX_EncoderBenchmark *result)
+{
+    static const NEX_Prefix speedPrefix = NEX_PREFIX("nSd.val=");
+    uint32_t formatTotal = 0, encoderTotal = 0;
+
+    if (result == NULL || iterations == 0)
+        return;
+
+    Cycle_Counter_Init();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        char command[21];
+        NEX_Frame_Begin();
+        uint32_t start = Cycle_Counter_Get();
+        snprintf(command, sizeof(command), "nSd.val=%d", (int)value);
+        NEX_Frame_Append(command);
+        formatTotal += Cycle_Counter_Get() - start;
+
+        NEX_Frame_Begin();
+        start = Cycle_Counter_Get();
+        NEX_Frame_Append_Int(&speedPrefix, value);
+        encoderTotal += Cycle_Counter_Get() - start;
+    }
+
+    // Discard the measurement frames
+    _length = 0;
+    _commands = 0;
+    _capacity = 0;
+
+    result->snprintfCycles = formatTotal / iterations;
+    result->encoderCycles = encoderTotal / iterations;
+}
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Writes the decimal representation of a value right-aligned
+  *         in front of end, two digits per step.
+  * @param  value: Signed value to convert.
+  * @param  end:   One past the last character of the destination.
+  * @retval Number of characters written (1..11).
+  */
+static uint8_t Int_To_Ascii(int32_t value, char *end)
+{
+    char *p = end;
+    // Unsigned negate keeps INT32_MIN well defined
+    uint32_t u = (value < 0) ? (0U - (uint32_t)value) : (uint32_t)value;
+
+    while (u >= 100U) {
+        uint32_t q = u / 100U;
+        uint32_t r = u - q * 100U;
+        p -= 2;
+        p[0] = DIGIT_PAIRS[2U * r];
+        p[1] = DIGIT_PAIRS[2U * r + 1U];
+        u = q;
+    }
+
+    if (u >= 10U) {
+        p -= 2;
+        p[0] = DIGIT_PAIRS[2U * u];
+        p[1] = DIGIT_PAIRS[2U * u + 1U];
+    } else {
+        *--p = (char)('0' + u);
+    }
+
+    if (value < 0)
+        *--p = '-';
+
+    return (uint8_t)(end - p);
+}
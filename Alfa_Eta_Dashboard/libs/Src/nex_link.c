@@ -0,0 +1,351 @@
+/**
+ ******************************************************************************
+ * @file           : nex_link.c
+ * @brief          : DMA-driven TX ring queue for the Nextion UART link
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * Bytes written with NEX_Link_Write() are copied into a ring buffer. Whenever
+ * the DMA is idle, the longest contiguous chunk starting at the tail is handed
+ * to the UART TX DMA stream. The transfer-complete interrupt releases that
+ * chunk and immediately starts the next one, so the queue drains without any
+ * CPU involvement from the main loop.
+ *
+ * Every write is stored contiguously: if a block does not fit between the head
+ * and the physical end of the ring, the end is skipped and the block starts at
+ * offset 0 (the skipped bytes are never sent). A block written while the DMA is
+ * idle therefore always leaves in a single transfer.
+ *
+ * Concurrency model:
+ *  - Only the main context writes (head), only the ISR releases (tail).
+ *  - The shared byte count, the wrap state and the busy flag are updated with
+ *    interrupts masked, which keeps the critical sections a few instructions long.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nex_link.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief UART handle the queue is drained into.
+ */
+static UART_HandleTypeDef *_uart = NULL;
+
+/**
+ * @brief Ring buffer storage.
+ */
+static uint8_t _queue[NEX_LINK_TX_QUEUE_SIZE];
+
+static uint16_t _head = 0;              /*!< Next write position (main context only) */
+static volatile uint16_t _tail = 0;     /*!< Start of the oldest unsent byte (ISR only once running) */
+static volatile uint16_t _wrapMark = 0; /*!< End of valid data in the upper segment while wrapped */
+static volatile uint8_t _wrapped = 0;   /*!< 1 while data occupies [tail, wrapMark) and [0, head) */
+static volatile uint16_t _count = 0;    /*!< Bytes in the queue, including the chunk in flight */
+static volatile uint16_t _inFlight = 0; /*!< Length of the chunk currently owned by the DMA */
+static volatile uint8_t _busy = 0;      /*!< 1 while a DMA transfer is running */
+static volatile uint8_t _paused = 0;    /*!< 1 while NEX_Link_Pause() holds transfers back */
+static volatile uint32_t _pauseStart = 0; /*!< HAL tick at which the pause began */
+static volatile uint32_t _pauseMs = 0;  /*!< Length of the pause */
+
+/**
+ * @brief Queue counters reported through NEX_Link_Get_Stats().
+ */
+static NEX_Link_Stats _stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Nex_Link_Private_Functions
+  * @{
+  */
+static void Link_Kick(void);
+static void Link_Release(void);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Binds the UART handle and resets the queue and its counters.
+  * @param  uart: Pointer to the UART handle used for Nextion communication.
+  * @retval HAL_OK on success, HAL_ERROR if uart is NULL.
+  */
+HAL_StatusTypeDef NEX_Link_Init(UART_HandleTypeDef *uart)
+{
+    if (uart == NULL)
+        return HAL_ERROR;
+
+    _uart = uart;
+    _head = 0;
+    _tail = 0;
+    _wrapMark = 0;
+    _wrapped = 0;
+    _count = 0;
+    _inFlight = 0;
+    _busy = 0;
+    _paused = 0;
+    memset(&_stats, 0, sizeof(_stats));
+    return HAL_OK;
+}
+
+/**
+  * @brief  Copies a block of bytes into the ring and kicks the DMA.
+  *
+  *         The write is rejected as a whole when no contiguous free block of
+  *         len bytes exists, so a partially queued command can never corrupt
+  *         the Nextion command stream.
+  *
+  * @param  data: Bytes to send.
+  * @param  len:  Number of bytes.
+  * @retval HAL_OK if queued, HAL_ERROR on overflow or if the link is not bound.
+  */
+HAL_StatusTypeDef NEX_Link_Write(const uint8_t *data, uint16_t len)
+{
+    if (_uart == NULL || data == NULL)
+        return HAL_ERROR;
+
+    if (len == 0)
+        return HAL_OK;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_count == 0 && !_busy) {
+        // Queue is empty: restart at offset 0 to get the largest contiguous block
+        _head = 0;
+        _tail = 0;
+        _wrapped = 0;
+    }
+    uint8_t wrap = 0;
+    if (!_wrapped && NEX_LINK_TX_QUEUE_SIZE - _head < len) {
+        wrap = 1;   // Does not fit before the end: skip it and start over at 0
+    }
+    uint16_t room = _wrapped ? (uint16_t)(_tail - _head)
+                  : wrap     ? _tail
+                  :            (NEX_LINK_TX_QUEUE_SIZE - _head);
+    __set_PRIMASK(primask);
+
+    if (len > room) {
+        _stats.overflows++;
+        return HAL_ERROR;
+    }
+
+    // The ISR can only release bytes meanwhile, so the region stays free
+    uint16_t start = wrap ? 0 : _head;
+    memcpy(&_queue[start], data, len);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (wrap) {
+        _wrapMark = _head;
+        _wrapped = 1;
+    }
+    _head = start + len;
+    _count += len;
+    if (_count > _stats.peakDepth)
+        _stats.peakDepth = _count;
+    _stats.bytesQueued += len;
+    Link_Kick();
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  Returns the size of the largest block NEX_Link_Write() accepts now.
+  * @note   The value can only grow until the next write, because the ISR
+  *         only releases space.
+  */
+uint16_t NEX_Link_Get_Free(void)
+{
+    uint16_t room;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_count == 0 && !_busy) {
+        room = NEX_LINK_TX_QUEUE_SIZE;
+    } else if (_wrapped) {
+        room = _tail - _head;
+    } else {
+        uint16_t end = NEX_LINK_TX_QUEUE_SIZE - _head;
+        room = (end > _tail) ? end : _tail;
+    }
+    __set_PRIMASK(primask);
+
+    return room;
+}
+
+/**
+  * @brief  Returns the number of queued bytes, including the chunk in flight.
+  */
+uint16_t NEX_Link_Get_Depth(void)
+{
+    return _count;
+}
+
+/**
+  * @brief  Waits until every queued byte has been handed to the UART.
+  * @param  timeout: Maximum time to wait in milliseconds.
+  * @retval HAL_OK if drained, HAL_TIMEOUT otherwise.
+  * @note   Used before operations that need a quiet line, such as
+  *         reconfiguring the UART.
+  */
+HAL_StatusTypeDef NEX_Link_Flush(uint32_t timeout)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (_count != 0) {
+        if (HAL_GetTick() - start >= timeout)
+            return HAL_TIMEOUT;
+
+        // Restart draining in case a previous kick found the UART busy
+        NEX_Link_Service();
+    }
+    return HAL_OK;
+}
+
+/**
+  * @brief  Stops starting new transfers for pauseMs milliseconds.
+  * @param  pauseMs: Pause length in milliseconds.
+  * @note   A second call while paused restarts the pause.
+  */
+void NEX_Link_Pause(uint32_t pauseMs)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    _pauseStart = HAL_GetTick();
+    _pauseMs = pauseMs;
+    _paused = 1;
+    _stats.pauses++;
+    __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Kicks the DMA if data is waiting, e.g. after a pause has expired.
+  */
+void NEX_Link_Service(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Link_Kick();
+    __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Copies the queue counters into the given structure.
+  * @param  stats: Destination structure.
+  */
+void NEX_Link_Get_Stats(NEX_Link_Stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = _stats;
+    stats->depth = _count;
+    __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Releases the finished chunk and starts the next one.
+  * @param  huart: UART handle that completed its transfer.
+  * @note   Runs in interrupt context.
+  */
+void NEX_Link_TxCplt_Callback(UART_HandleTypeDef *huart)
+{
+    if (huart != _uart || !_busy)
+        return;
+
+    Link_Release();
+    Link_Kick();
+}
+
+/**
+  * @brief  Recovers the queue after a UART/DMA error.
+  *
+  *         HAL aborts the TX transfer on a DMA error and leaves gState READY.
+  *         The chunk in flight is dropped (its bytes may be partially on the
+  *         wire already) and draining resumes with the next chunk.
+  *
+  * @param  huart: UART handle that reported the error.
+  * @note   Runs in interrupt context.
+  */
+void NEX_Link_Error_Callback(UART_HandleTypeDef *huart)
+{
+    if (huart != _uart || !_busy || huart->gState != HAL_UART_STATE_READY)
+        return;
+
+    _stats.errors++;
+    Link_Release();
+    Link_Kick();
+}
+
+/**
+  * @brief  Default transfer hook: sends the chunk with the UART TX DMA.
+  * @param  uart: UART handle bound by NEX_Link_Init().
+  * @param  data: Start of the chunk.
+  * @param  len:  Chunk length in bytes.
+  * @retval HAL status returned by HAL_UART_Transmit_DMA().
+  */
+__weak HAL_StatusTypeDef NEX_Link_Start_Transmit(UART_HandleTypeDef *uart, const uint8_t *data, uint16_t len)
+{
+    return HAL_UART_Transmit_DMA(uart, data, len);
+}
+
+/**
+  * @brief  Starts a DMA transfer of the oldest contiguous chunk if idle.
+  * @note   Caller must hold interrupts masked or run in the ISR.
+  */
+static void Link_Kick(void)
+{
+    if (_busy || _count == 0)
+        return;
+
+    if (_paused) {
+        if (HAL_GetTick() - _pauseStart < _pauseMs)
+            return;     // Display asked us to back off
+        _paused = 0;
+    }
+
+    if (_wrapped && _tail == _wrapMark) {
+        // Upper segment fully sent: continue with the block at offset 0
+        _tail = 0;
+        _wrapped = 0;
+    }
+
+    // DMA needs a linear block: the upper segment or everything up to the head
+    uint16_t chunk = _wrapped ? (_wrapMark - _tail) : (_head - _tail);
+
+    _busy = 1;
+    _inFlight = chunk;
+    _stats.transfers++;
+
+    if (NEX_Link_Start_Transmit(_uart, &_queue[_tail], chunk) != HAL_OK) {
+        // UART still owned by a blocking call; retry on the next write or completion
+        _busy = 0;
+        _inFlight = 0;
+        _stats.transfers--;
+    }
+}
+
+/**
+  * @brief  Returns the in-flight chunk to the free space of the ring.
+  * @note   Caller must hold interrupts masked or run in the ISR.
+  */
+static void Link_Release(void)
+{
+    _tail += _inFlight;
+    _count -= _inFlight;
+    _inFlight = 0;
+    _busy = 0;
+}
@@ -0,0 +1,375 @@
+/**
+ ******************************************************************************
+ * @file           : nex_rx.c
+ * @brief          : DMA/IDLE-line receiver and response dispatcher for Nextion
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * HAL_UARTEx_ReceiveToIdle_DMA() keeps the RX DMA stream writing into a
+ * circular buffer. The RX event callback (IDLE line, half and full transfer)
+ * passes the DMA write position, and every byte between the previous and the
+ * new position is fed to a small framing state machine.
+ *
+ * Most return codes have a fixed payload length, which is used so that 0xFF
+ * bytes inside numeric data are not mistaken for the terminator. Only the
+ * variable-length responses (string data, start-up message) are delimited by
+ * the 0xFF 0xFF 0xFF run alone. Bytes that cannot start a response are
+ * dropped until the stream resynchronises.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nex_rx.h"
+#include "nex_link.h"
+#include <string.h>
+
+/* Private Constants ---------------------------------------------------------*/
+
+#define LENGTH_UNKNOWN  0xFFFFU   /*!< Byte is not a Nextion return code */
+#define LENGTH_VARIABLE 0xFFFEU   /*!< Payload ends at the terminator */
+
+#define TERMINATOR_LENGTH 3U      /*!< 0xFF 0xFF 0xFF */
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  Handler table entry.
+  */
+typedef struct {
+    uint8_t code;              /*!< Return code */
+    NEX_Rx_Handler handler;    /*!< Function called for that code */
+} NEX_Rx_Entry;
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief UART handle the receiver is bound to.
+ */
+static UART_HandleTypeDef *_uart = NULL;
+
+/**
+ * @brief Circular DMA buffer.
+ */
+static uint8_t _buffer[NEX_RX_BUFFER_SIZE];
+
+/**
+ * @brief Registered response handlers.
+ */
+static NEX_Rx_Entry _handlers[NEX_RX_MAX_HANDLERS];
+static uint8_t _handlerCount = 0;
+
+static uint16_t _position = 0;       /*!< Next buffer index to parse */
+static uint16_t _frameStart = 0;     /*!< Buffer index of the current code byte */
+static uint16_t _frameLength = 0;    /*!< Bytes of the current response so far, 0 = idle */
+static uint16_t _expected = 0;       /*!< Payload length of the current response */
+static uint8_t _terminators = 0;     /*!< 0xFF bytes at the end of the current response */
+static uint8_t _lastByte = 0;        /*!< Previous byte outside a response ("OK" detection) */
+static volatile uint8_t _okReceived = 0;
+
+/**
+ * @brief Receiver counters reported through NEX_Rx_Get_Stats().
+ */
+static NEX_Rx_Stats _stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Nex_Rx_Private_Functions
+  * @{
+  */
+static uint16_t Payload_Length(uint8_t code);
+static void Parse_Byte(uint8_t byte, uint16_t index);
+static void Dispatch(uint16_t payloadLength);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Binds the UART handle, clears the handler table and starts the DMA.
+  * @param  uart: Pointer to the UART handle used for Nextion communication.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NEX_Rx_Init(UART_HandleTypeDef *uart)
+{
+    if (uart == NULL)
+        return HAL_ERROR;
+
+    _uart = uart;
+    _handlerCount = 0;
+    _okReceived = 0;
+    memset(&_stats, 0, sizeof(_stats));
+
+    return NEX_Rx_Start();
+}
+
+/**
+  * @brief  Resets the parser and starts the circular reception.
+  * @retval HAL status of the reception request.
+  */
+HAL_StatusTypeDef NEX_Rx_Start(void)
+{
+    if (_uart == NULL)
+        return HAL_ERROR;
+
+    _position = 0;
+    _frameLength = 0;
+    _lastByte = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(_uart, _buffer, NEX_RX_BUFFER_SIZE);
+}
+
+/**
+  * @brief  Aborts the reception.
+  * @retval None
+  */
+void NEX_Rx_Stop(void)
+{
+    if (_uart != NULL)
+        HAL_UART_AbortReceive(_uart);
+}
+
+/**
+  * @brief  Adds or replaces the handler of a return code.
+  * @param  code:    Return code.
+  * @param  handler: Handler function, NULL removes the entry.
+  * @retval HAL_OK on success, HAL_ERROR if the table is full.
+  */
+HAL_StatusTypeDef NEX_Rx_Register_Handler(uint8_t code, NEX_Rx_Handler handler)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t i = 0;
+    while (i < _handlerCount && _handlers[i].code != code)
+        i++;
+
+    if (handler == NULL) {
+        if (i < _handlerCount)
+            _handlers[i] = _handlers[--_handlerCount];
+    } else if (i < _handlerCount) {
+        _handlers[i].handler = handler;
+    } else if (_handlerCount < NEX_RX_MAX_HANDLERS) {
+        _handlers[_handlerCount].code = code;
+        _handlers[_handlerCount].handler = handler;
+        _handlerCount++;
+    } else {
+        status = HAL_ERROR;
+    }
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+/**
+  * @brief  Returns and clears the "OK received" flag.
+  * @retval 1 if "OK" arrived since the last call, 0 otherwise.
+  */
+uint8_t NEX_Rx_Take_Ok(void)
+{
+    if (!_okReceived)
+        return 0;
+
+    _okReceived = 0;
+    return 1;
+}
+
+/**
+  * @brief  Returns payload byte index of a view.
+  * @param  view:  Payload view.
+  * @param  index: Byte index.
+  * @retval Payload byte.
+  */
+uint8_t NEX_Rx_View_Byte(const NEX_RxView *view, uint16_t index)
+{
+    return (index < view->firstLength) ? view->first[index]
+                                       : view->second[index - view->firstLength];
+}
+
+/**
+  * @brief  Copies the receiver counters into the given structure.
+  * @param  stats: Destination structure.
+  */
+void NEX_Rx_Get_Stats(NEX_Rx_Stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = _stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Parses everything the DMA wrote since the previous event.
+  * @param  huart: UART handle that reported the event.
+  * @param  size:  DMA write position (1..NEX_RX_BUFFER_SIZE).
+  * @note   Runs in interrupt context (IDLE line, half and full transfer).
+  */
+void NEX_Rx_Event_Callback(UART_HandleTypeDef *huart, uint16_t size)
+{
+    if (huart != _uart)
+        return;
+
+    uint16_t end = size % NEX_RX_BUFFER_SIZE;
+
+    while (_position != end) {
+        Parse_Byte(_buffer[_position], _position);
+        _position = (_position + 1U) % NEX_RX_BUFFER_SIZE;
+    }
+}
+
+/**
+  * @brief  Restarts the reception after HAL aborted it on a UART error.
+  *
+  *         With DMA reception every receive error (overrun, noise, framing)
+  *         stops the circular transfer and leaves RxState READY. Framing and
+  *         noise errors are counted separately: a burst of them means the
+  *         display sends at another baud rate, e.g. after a reboot.
+  *
+  * @param  huart: UART handle that reported the error.
+  * @note   Runs in interrupt context.
+  */
+void NEX_Rx_Error_Callback(UART_HandleTypeDef *huart)
+{
+    if (huart != _uart)
+        return;
+
+    if (huart->ErrorCode & (HAL_UART_ERROR_FE | HAL_UART_ERROR_NE))
+        _stats.lineErrors++;
+    if (huart->RxState != HAL_UART_STATE_READY)
+        return;
+
+    _stats.restarts++;
+    NEX_Rx_Start();
+}
+
+/**
+  * @brief  Returns the payload length of a Nextion return code.
+  * @param  code: First byte of a response.
+  * @retval Payload length, LENGTH_VARIABLE or LENGTH_UNKNOWN.
+  */
+static uint16_t Payload_Length(uint8_t code)
+{
+    switch (code) {
+    case NEX_RX_INVALID_INSTRUCTION:
+        return LENGTH_VARIABLE;      // "00 FF FF FF" or start-up "00 00 00 FF FF FF"
+    case NEX_RX_TOUCH_EVENT:
+        return 3U;                   // page, component, event
+    case NEX_RX_CURRENT_PAGE:
+        return 1U;
+    case 0x67U:
+    case 0x68U:
+        return 5U;                   // x, y (big-endian), event
+    case NEX_RX_STRING_DATA:
+        return LENGTH_VARIABLE;
+    case NEX_RX_NUMERIC_DATA:
+        return 4U;
+    case 0x86U:
+    case 0x87U:
+    case NEX_RX_READY:
+    case 0x89U:
+    case NEX_RX_TRANSPARENT_END:
+    case NEX_RX_TRANSPARENT_READY:
+        return 0U;
+    default:
+        return (code <= NEX_RX_BUFFER_OVERFLOW) ? 0U : LENGTH_UNKNOWN;
+    }
+}
+
+/**
+  * @brief  Feeds one received byte to the framing state machine.
+  * @param  byte:  Received byte.
+  * @param  index: Buffer index of the byte.
+  */
+static void Parse_Byte(uint8_t byte, uint16_t index)
+{
+    _stats.bytes++;
+
+    if (_frameLength == 0) {
+        uint16_t expected = Payload_Length(byte);
+
+        if (expected == LENGTH_UNKNOWN) {
+            if (byte == 'K' && _lastByte == 'O')
+                _okReceived = 1;        // Handshake message, not a framed response
+            else if (byte != 'O')
+                _stats.dropped++;
+            _lastByte = byte;
+            return;
+        }
+
+        _frameStart = index;
+        _frameLength = 1;
+        _expected = expected;
+        _terminators = 0;
+        _lastByte = 0;
+        return;
+    }
+
+    _frameLength++;
+    uint16_t received = _frameLength - 1U;   // Bytes after the code byte
+
+    if (_expected != LENGTH_VARIABLE && received <= _expected)
+        return;                         // Fixed-length payload, any value allowed
+
+    if (byte == 0xFFU) {
+        if (++_terminators == TERMINATOR_LENGTH) {
+            Dispatch(received - TERMINATOR_LENGTH);
+            _frameLength = 0;
+        }
+        return;
+    }
+
+    if (_expected != LENGTH_VARIABLE || received > NEX_RX_MAX_FRAME + TERMINATOR_LENGTH) {
+        _stats.dropped += _frameLength;  // Corrupt response: resynchronise
+        _frameLength = 0;
+        return;
+    }
+    _terminators = 0;
+}
+
+/**
+  * @brief  Updates the counters and calls the handler of a complete response.
+  * @param  payloadLength: Bytes between the code and the terminator.
+  */
+static void Dispatch(uint16_t payloadLength)
+{
+    uint8_t code = _buffer[_frameStart];
+    uint16_t payload = (_frameStart + 1U) % NEX_RX_BUFFER_SIZE;
+    NEX_RxView view;
+
+    view.first = &_buffer[payload];
+    view.firstLength = NEX_RX_BUFFER_SIZE - payload;
+    if (view.firstLength >= payloadLength) {
+        view.firstLength = payloadLength;
+        view.second = NULL;
+        view.secondLength = 0;
+    } else {
+        view.second = _buffer;
+        view.secondLength = payloadLength - view.firstLength;
+    }
+
+    _stats.frames++;
+    if (code == NEX_RX_BUFFER_OVERFLOW) {
+        _stats.overflows++;
+        NEX_Link_Pause(NEX_RX_OVERFLOW_PAUSE_MS);
+    } else if (code != NEX_RX_SUCCESS && code < NEX_RX_BUFFER_OVERFLOW && payloadLength == 0) {
+        _stats.errors++;
+        _stats.lastError = code;
+    }
+
+    for (uint8_t i = 0; i < _handlerCount; i++) {
+        if (_handlers[i].code == code) {
+            _handlers[i].handler(code, &view);
+            break;
+        }
+    }
+}
@@ -0,0 +1,467 @@
+/**
+ ******************************************************************************
+ * @file           : nmea_parser.c
+ * @brief          : Byte-at-a-time NMEA 0183 state machine
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @details
+ * Every byte is handled once: it is checked, XORed into the checksum and
+ * stored in the line buffer, or, for a ',', stored as '\0' while the next
+ * field offset is noted. When the line ending arrives, the checksum is
+ * compared and the sentence is dispatched by its address. The parser costs
+ * a fixed number of cycles per byte, whatever the sentence type.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nmea_parser.h"
+#include <string.h>
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+#include "cycle_counter.h"
+#endif
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  Parser states.
+  */
+typedef enum {
+    NMEA_WAIT_START = 0,     /*!< Skipping bytes until '$' */
+    NMEA_BODY,               /*!< Between '$' and '*' */
+    NMEA_CHECKSUM_HIGH,      /*!< First checksum digit */
+    NMEA_CHECKSUM_LOW,       /*!< Second checksum digit */
+    NMEA_WAIT_END            /*!< Expecting CR or LF */
+} NMEA_State;
+
+/**
+  * @brief  Handler table entry.
+  */
+typedef struct {
+    char address[NMEA_ADDRESS_SIZE + 1U]; /*!< Sentence address */
+    NMEA_Handler handler;                 /*!< Function called for that address */
+} NMEA_Entry;
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Line buffer holding the body of the current sentence.
+ */
+static char _line[NMEA_MAX_SENTENCE + 1U];
+
+/**
+ * @brief Field offsets of the current sentence, handed to the handlers.
+ */
+static NMEA_Sentence _sentence = {.text = _line};
+
+static NMEA_State _state = NMEA_WAIT_START;
+static uint8_t _length = 0;      /*!< Characters in _line */
+static uint8_t _checksum = 0;    /*!< XOR of the body received so far */
+static uint8_t _received = 0;    /*!< Checksum sent with the sentence */
+
+/**
+ * @brief Registered sentence handlers.
+ */
+static NMEA_Entry _handlers[NMEA_MAX_HANDLERS];
+static uint8_t _handlerCount = 0;
+
+/**
+ * @brief Parser counters reported through NMEA_Parser_Get_Stats().
+ */
+static NMEA_Parser_Stats _stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Nmea_Parser_Private_Functions
+  * @{
+  */
+static void Parse_Byte(char c);
+static void Drop_Sentence(void);
+static void Dispatch(void);
+static uint8_t Address_Matches(const char *pattern, const char *address);
+static int8_t Hex_Value(char c);
+/**
+  * @}
+  */
+
+
+/**
+  * @brief  Clears the handler table, the partial sentence and the counters.
+  * @retval None
+  */
+void NMEA_Parser_Init(void)
+{
+    _handlerCount = 0;
+    memset(&_stats, 0, sizeof(_stats));
+    NMEA_Parser_Reset();
+}
+
+/**
+  * @brief  Drops the partial sentence.
+  * @retval None
+  */
+void NMEA_Parser_Reset(void)
+{
+    _state = NMEA_WAIT_START;
+    _length = 0;
+}
+
+/**
+  * @brief  Adds or replaces the handler of a sentence address.
+  * @param  address: Talker and sentence type, exactly NMEA_ADDRESS_SIZE
+  *                  characters; '-' matches any character.
+  * @param  handler: Handler function, NULL removes the entry.
+  * @retval HAL_OK on success, HAL_ERROR on a bad address or a full table.
+  */
+HAL_StatusTypeDef NMEA_Parser_Register_Handler(const char *address, NMEA_Handler handler)
+{
+    if (address == NULL || strlen(address) != NMEA_ADDRESS_SIZE)
+        return HAL_ERROR;
+
+    uint8_t i = 0;
+    while (i < _handlerCount && strcmp(_handlers[i].address, address) != 0)
+        i++;
+
+    if (handler == NULL) {
+        if (i < _handlerCount)
+            _handlers[i] = _handlers[--_handlerCount];
+    } else if (i < _handlerCount) {
+        _handlers[i].handler = handler;
+    } else if (_handlerCount < NMEA_MAX_HANDLERS) {
+        memcpy(_handlers[_handlerCount].address, address, NMEA_ADDRESS_SIZE + 1U);
+        _handlers[_handlerCount].handler = handler;
+        _handlerCount++;
+    } else {
+        return HAL_ERROR;
+    }
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  Runs the state machine over received bytes.
+  * @param  data:   Received bytes.
+  * @param  length: Number of bytes.
+  * @retval None
+  */
+void NMEA_Parser_Feed(const uint8_t *data, uint16_t length)
+{
+    if (data == NULL)
+        return;
+
+    _stats.bytes += length;
+    for (uint16_t i = 0; i < length; i++)
+        Parse_Byte((char)data[i]);
+}
+
+/**
+  * @brief  Returns a field of a sentence.
+  * @param  sentence: Sentence passed to a handler.
+  * @param  index:    Field index, 0 = address.
+  * @retval Null-terminated field, "" if it is empty or does not exist.
+  */
+const char *NMEA_Parser_Field(const NMEA_Sentence *sentence, uint8_t index)
+{
+    if (sentence == NULL || index >= sentence->fields)
+        return "";
+
+    return &sentence->text[sentence->offsets[index]];
+}
+
+/**
+  * @brief  Converts a decimal field to a scaled integer.
+  *
+  *         Digits after the requested decimals are truncated, missing ones
+  *         count as zero. A value that does not fit an int32_t is rejected.
+  *
+  * @param  text:     Field text, optionally signed.
+  * @param  decimals: Number of decimals kept, 0..6.
+  * @param  value:    Destination for the scaled value.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NMEA_Parser_To_Fixed(const char *text, uint8_t decimals, int32_t *value)
+{
+    int32_t result = 0;
+    uint8_t digits = 0, fraction = 0, point = 0, negative = 0;
+
+    if (text == NULL || value == NULL || decimals > 6U)
+        return HAL_ERROR;
+
+    if (*text == '-') {
+        negative = 1;
+        text++;
+    }
+
+    for (; *text != '\0'; text++) {
+        if (*text == '.' && !point) {
+            point = 1;
+        } else if (*text >= '0' && *text <= '9') {
+            if (point && fraction == decimals)
+                continue;               // Beyond the requested resolution
+            int32_t digit = *text - '0';
+            if (result > (INT32_MAX - digit) / 10)
+                return HAL_ERROR;
+            result = result * 10 + digit;
+            digits++;
+            if (point)
+                fraction++;
+        } else {
+            return HAL_ERROR;
+        }
+    }
+
+    if (digits == 0)
+        return HAL_ERROR;
+
+    for (; fraction < decimals; fraction++) {
+        if (result > INT32_MAX / 10)
+            return HAL_ERROR;
+        result *= 10;
+    }
+
+    *value = negative ? -result : result;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Converts an NMEA coordinate to 1e-7 degrees.
+  *
+  *         The field is read as minutes with 5 decimals (1.85 cm), then
+  *         degrees * 10^7 + minutes * 10^7 / 60, rounded, all in int32_t.
+  *
+  * @param  text:       Coordinate field, "ddmm.mmmmm" or "dddmm.mmmmm".
+  * @param  hemisphere: Hemisphere field.
+  * @param  value:      Destination in 1e-7 degrees.
+  * @retval HAL_OK on success, HAL_ERROR otherwise.
+  */
+HAL_StatusTypeDef NMEA_Parser_To_Coordinate(const char *text, const char *hemisphere, int32_t *value)
+{
+    int32_t raw;
+
+    if (hemisphere == NULL || value == NULL || *text == '-')
+        return HAL_ERROR;
+    if (NMEA_Parser_To_Fixed(text, 5, &raw) != HAL_OK)
+        return HAL_ERROR;
+
+    int32_t degrees = raw / 10000000L;      // dddmm.mmmmm * 10^5
+    int32_t minutes = raw % 10000000L;      // Minutes in 1e-5
+
+    if (degrees > 180 || minutes >= 6000000L)
+        return HAL_ERROR;
+
+    int32_t result = degrees * NMEA_COORDINATE_SCALE + (minutes * 5 + 1) / 3;  // 10^7 / (60 * 10^5) = 5 / 3
+
+    switch (hemisphere[0]) {
+    case 'N':
+    case 'E':
+        break;
+    case 'S':
+    case 'W':
+        result = -result;
+        break;
+    default:
+        return HAL_ERROR;
+    }
+
+    *value = result;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Copies the parser counters.
+  * @param  stats: Destination structure.
+  * @retval None
+  */
+void NMEA_Parser_Get_Stats(NMEA_Parser_Stats *stats)
+{
+    if (stats != NULL)
+        *stats = _stats;
+}
+
+#ifdef DASHBOARD_ENABLE_BENCHMARK
+/**
+  * @brief  Feeds one second of typical receiver output repeatedly.
+  *
+  *         The handler table and the counters are set aside during the
+  *         measurement, so the application does not see the samples.
+  *
+  * @param  iterations: Passes over the sample sentences.
+  * @param  result:     Destination for the measurement.
+  * @retval None
+  */
+void NMEA_Parser_Benchmark(uint32_t iterations, NMEA_ParserBenchmark *result)
+{
+    static const char samples[] =
+        "$GNRMC,123519.00,A,4047.24583,N,02927.08390,E,22.4,84.4,150326,,,A*41\r\n"
+        "$GNGGA,123519.00,4047.24583,N,02927.08390,E,1,08,0.9,545.4,M,46.9,M,,*76\r\n"
+        "$GNGSA,A,3,04,05,09,12,24,,,,,,,,2.5,1.3,2.1*27\r\n";
+    const uint16_t sampleLength = sizeof(samples) - 1U;
+    const uint32_t sampleSentences = 3U;
+    uint32_t total = 0;
+
+    if (result == NULL || iterations == 0)
+        return;
+
+    NMEA_Parser_Stats stats = _stats;
+    uint8_t handlerCount = _handlerCount;
+    _handlerCount = 0;
+
+    NMEA_Parser_Reset();
+    Cycle_Counter_Init();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t start = Cycle_Counter_Get();
+        NMEA_Parser_Feed((const uint8_t *)samples, sampleLength);
+        total += Cycle_Counter_Get() - start;
+    }
+
+    _handlerCount = handlerCount;
+    _stats = stats;
+
+    result->cyclesPerByte = total / (iterations * sampleLength);
+    result->cyclesPerSentence = total / (iterations * sampleSentences);
+    result->sentencesPerSecond = (result->cyclesPerSentence != 0)
+                               ? SystemCoreClock / result->cyclesPerSentence : 0;
+}
+#endif // DASHBOARD_ENABLE_BENCHMARK
+
+/**
+  * @brief  Advances the state machine by one byte.
+  * @param  c: Received byte.
+  * @retval None
+  */
+static void Parse_Byte(char c)
+{
+    if (c == '$') {
+        if (_state != NMEA_WAIT_START)
+            _stats.framingErrors++;     // The previous sentence was cut off
+
+        _state = NMEA_BODY;
+        _length = 0;
+        _checksum = 0;
+        _received = 0;
+        _sentence.fields = 1;
+        _sentence.offsets[0] = 0;
+        return;
+    }
+
+    switch (_state) {
+    case NMEA_WAIT_START:
+        break;
+
+    case NMEA_BODY:
+        if (c == '*') {
+            _line[_length] = '\0';
+            _state = NMEA_CHECKSUM_HIGH;
+        } else if (c < ' ' || c > '~' || _length >= NMEA_MAX_SENTENCE) {
+            Drop_Sentence();
+        } else if (c == ',') {
+            if (_sentence.fields >= NMEA_MAX_FIELDS) {
+                Drop_Sentence();
+                break;
+            }
+            _checksum ^= (uint8_t)c;
+            _line[_length++] = '\0';
+            _sentence.offsets[_sentence.fields++] = _length;
+        } else {
+            _checksum ^= (uint8_t)c;
+            _line[_length++] = c;
+        }
+        break;
+
+    case NMEA_CHECKSUM_HIGH:
+    case NMEA_CHECKSUM_LOW: {
+        int8_t digit = Hex_Value(c);
+
+        if (digit < 0) {
+            Drop_Sentence();
+            break;
+        }
+        _received = (uint8_t)((_received << 4) | (uint8_t)digit);
+        _state = (_state == NMEA_CHECKSUM_HIGH) ? NMEA_CHECKSUM_LOW : NMEA_WAIT_END;
+        break;
+    }
+
+    case NMEA_WAIT_END:
+        if (c == '\r' || c == '\n')
+            Dispatch();
+        else
+            Drop_Sentence();
+        break;
+    }
+}
+
+/**
+  * @brief  Abandons a malformed sentence.
+  * @retval None
+  */
+static void Drop_Sentence(void)
+{
+    _state = NMEA_WAIT_START;
+    _stats.framingErrors++;
+}
+
+/**
+  * @brief  Validates the finished sentence and calls its handler.
+  * @retval None
+  */
+static void Dispatch(void)
+{
+    _state = NMEA_WAIT_START;
+
+    if (_received != _checksum) {
+        _stats.checksumErrors++;
+        return;
+    }
+
+    _stats.sentences++;
+
+    for (uint8_t i = 0; i < _handlerCount; i++) {
+        if (Address_Matches(_handlers[i].address, _line)) {
+            _handlers[i].handler(&_sentence);
+            return;
+        }
+    }
+
+    _stats.unhandled++;
+}
+
+/**
+  * @brief  Compares a sentence address with a registered one.
+  * @param  pattern: Registered address, '-' matching any character.
+  * @param  address: Address field of the sentence.
+  * @retval 1 on a match, 0 otherwise.
+  */
+static uint8_t Address_Matches(const char *pattern, const char *address)
+{
+    for (uint8_t i = 0; i < NMEA_ADDRESS_SIZE; i++) {
+        if (address[i] == '\0' || (pattern[i] != '-' && pattern[i] != address[i]))
+            return 0;
+    }
+
+    return address[NMEA_ADDRESS_SIZE] == '\0';
+}
+
+/**
+  * @brief  Converts a hexadecimal digit.
+  * @param  c: Character.
+  * @retval Digit value 0..15, -1 if c is not a hexadecimal digit.
+  */
+static int8_t Hex_Value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return (int8_t)(c - '0');
+    if (c >= 'A' && c <= 'F')
+        return (int8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f')
+        return (int8_t)(c - 'a' + 10);
+    return -1;
+}
@@ -0,0 +1,449 @@
+/**
+ ******************************************************************************
+ * @file           : nex_link_sim.c
+ * @brief          : Host harness for the Nextion TX ring queue
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Runs nex_link.c on the host against a simulated UART TX DMA. Build and run
+ * from the project directory:
+ *
+ *   gcc -std=gnu11 -O1 -g -fsanitize=address,undefined -fno-sanitize-recover
+ *       -Itests/stub -Ilibs/Inc tests/nex_link_sim.c libs/Src/nex_link.c
+ *       -o nex_link_sim
+ *   ./nex_link_sim [seed] [operations]
+ *
+ * NEX_Link_Start_Transmit() is overridden: the chunk is only remembered, and
+ * its bytes are read when the simulated transfer completes, so a write that
+ * lands on a chunk still owned by the DMA shows up as corrupted output. The
+ * completion (or a DMA error) is delivered through NEX_Link_TxCplt_Callback()
+ * and NEX_Link_Error_Callback() at random points: between calls, and every
+ * time the queue unmasks interrupts, i.e. inside NEX_Link_Write() between
+ * the room check and the copy. The DMA also refuses some starts, as a UART
+ * still owned by a blocking call would.
+ *
+ * Random writes, pauses and tick steps run against a model of the queue:
+ *  - every byte that leaves (sent or dropped by an error) must be the next
+ *    accepted byte, across any number of wrap-skips;
+ *  - every chunk must lie inside the ring and end before the next one starts;
+ *  - a write no larger than NEX_Link_Get_Free() must be accepted, and with
+ *    no interrupt in between one larger must be rejected as a whole;
+ *  - depth, peak depth, overflow, transfer, error and pause counters must
+ *    match the model;
+ *  - no transfer may start while a pause is running.
+ * The last phase flushes the queue and checks that nothing is left over.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nex_link.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LINK_SIM_DEFAULT_OPERATIONS 1000000U  /*!< Random operations per run */
+#define LINK_SIM_MODEL_SIZE 2048U             /*!< Model FIFO, holds the queue plus one block */
+#define LINK_SIM_FLUSH_TIMEOUT_MS 1000U       /*!< Flush wait of the final phase */
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  Counters kept by the model, compared with NEX_Link_Get_Stats().
+  */
+typedef struct {
+    uint32_t depth;          /*!< Accepted bytes that have not left yet */
+    uint32_t peakDepth;      /*!< Highest depth right after a write */
+    uint32_t overflows;      /*!< Rejected writes */
+    uint32_t bytesQueued;    /*!< Accepted bytes */
+    uint32_t transfers;      /*!< Starts the DMA accepted */
+    uint32_t errors;         /*!< Chunks dropped by a DMA error */
+    uint32_t pauses;         /*!< NEX_Link_Pause() calls */
+    uint32_t refusals;       /*!< Starts the DMA refused */
+    uint32_t wraps;          /*!< Chunks that started below the previous one */
+    uint32_t violations;     /*!< Broken rules, see the file header */
+} Sim_Model;
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint32_t _random = 1;         /*!< xorshift32 state */
+static UART_HandleTypeDef _uart;     /*!< Handle the queue is bound to */
+static Sim_Model _model;             /*!< Expected queue state */
+
+/**
+ * @brief Accepted bytes that have not left yet, in order.
+ */
+static uint8_t _fifo[LINK_SIM_MODEL_SIZE];
+static uint64_t _fifoIn = 0;         /*!< Bytes ever accepted */
+static uint64_t _fifoOut = 0;        /*!< Bytes ever sent or dropped */
+static uint16_t _staged = 0;         /*!< Bytes of the write in progress, past _fifoIn */
+
+static uint32_t _tick = 0;           /*!< Simulated HAL tick */
+static uint32_t _pauseEnd = 0;       /*!< Tick before which no transfer may start */
+static uint32_t _primask = 0;        /*!< Simulated PRIMASK */
+static uint8_t _inInterrupt = 0;     /*!< 1 while a simulated ISR runs */
+static uint8_t _quiet = 0;           /*!< 1: no interrupt is let in at unmask */
+static uint8_t _flushing = 0;        /*!< 1: every tick read completes the transfer */
+static uint32_t _unmasks = 0;        /*!< Unmasks since the current write started */
+static uint32_t _releasedEarly = 0;  /*!< Bytes released at the first unmask of a write */
+
+static const uint8_t *_chunk = NULL; /*!< Chunk owned by the DMA, NULL when idle */
+static uint16_t _chunkLength = 0;    /*!< Its length */
+static const uint8_t *_lastChunk = NULL;  /*!< Start of the previous chunk */
+static uint8_t _drained = 0;         /*!< 1 once the queue ran empty after _lastChunk */
+static const uint8_t *_ring = NULL;  /*!< Start of the ring, learned from the first chunk */
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Link_Sim_Private_Functions
+  * @{
+  */
+static uint32_t Random(void);
+static uint32_t Random_Below(uint32_t limit);
+static void Finish_Transfer(uint8_t error);
+static void Write_Block(void);
+static void Check_Depth(const char *where);
+static uint8_t Compare_Stats(void);
+/**
+  * @}
+  */
+
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : (uint32_t)time(NULL);
+    uint32_t operations = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : LINK_SIM_DEFAULT_OPERATIONS;
+    uint8_t failed = 0;
+
+    if (operations == 0) {
+        fprintf(stderr, "usage: %s [seed] [operations > 0]\n", argv[0]);
+        return 2;
+    }
+    _random = (seed != 0) ? seed : 1U;
+    printf("seed %lu, %lu operations\n", (unsigned long)seed, (unsigned long)operations);
+
+    _uart.gState = HAL_UART_STATE_READY;
+    if (NEX_Link_Write((const uint8_t *)"x", 1) != HAL_ERROR || NEX_Link_Init(NULL) != HAL_ERROR ||
+        NEX_Link_Init(&_uart) != HAL_OK) {
+        printf("FAIL init: unbound queue accepted a write or NULL was bound\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < operations; i++) {
+        uint32_t action = Random_Below(100);
+
+        if (action < 55) {
+            Write_Block();
+        } else if (action < 80) {
+            _inInterrupt = 1;
+            Finish_Transfer(0);
+            _inInterrupt = 0;
+        } else if (action < 83) {
+            _inInterrupt = 1;
+            Finish_Transfer(1);
+            _inInterrupt = 0;
+        } else if (action < 85) {
+            uint32_t pauseMs = 1 + Random_Below(20);
+
+            NEX_Link_Pause(pauseMs);
+            _pauseEnd = _tick + pauseMs;
+            _model.pauses++;
+        } else {
+            _tick += Random_Below(4);
+            NEX_Link_Service();
+        }
+        Check_Depth("step");
+    }
+
+    _flushing = 1;
+    if (NEX_Link_Flush(LINK_SIM_FLUSH_TIMEOUT_MS) != HAL_OK || NEX_Link_Get_Depth() != 0 ||
+        _fifoIn != _fifoOut || _chunk != NULL) {
+        printf("FAIL flush: %lu bytes left over\n", (unsigned long)(_fifoIn - _fifoOut));
+        failed = 1;
+    }
+    _flushing = 0;
+
+    failed |= Compare_Stats();
+    printf("%lu bytes, %lu transfers, %lu wraps, %lu overflows, %lu errors, %lu refusals, peak %lu\n",
+           (unsigned long)_model.bytesQueued, (unsigned long)_model.transfers,
+           (unsigned long)_model.wraps, (unsigned long)_model.overflows,
+           (unsigned long)_model.errors, (unsigned long)_model.refusals,
+           (unsigned long)_model.peakDepth);
+    if (_model.wraps == 0 || _model.overflows == 0 || _model.errors == 0) {
+        printf("FAIL coverage: no wrap, overflow or error in this run\n");
+        failed = 1;
+    }
+    if (_model.violations != 0) {
+        printf("FAIL %lu rule violations\n", (unsigned long)_model.violations);
+        failed = 1;
+    }
+
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
+
+/**
+  * @brief  Simulated HAL tick; while flushing, time passes and the DMA finishes.
+  * @retval Current tick.
+  */
+uint32_t HAL_GetTick(void)
+{
+    if (_flushing && !_inInterrupt && _primask == 0) {
+        _tick++;
+        _inInterrupt = 1;
+        Finish_Transfer(0);
+        _inInterrupt = 0;
+    }
+    return _tick;
+}
+
+/**
+  * @brief  Must not be reached: the harness overrides the transfer hook.
+  */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    _model.violations++;
+    return HAL_ERROR;
+}
+
+/**
+  * @brief  Simulated PRIMASK read.
+  */
+uint32_t __get_PRIMASK(void)
+{
+    return _primask;
+}
+
+/**
+  * @brief  Simulated interrupt mask.
+  */
+void __disable_irq(void)
+{
+    _primask = 1;
+}
+
+/**
+  * @brief  Simulated PRIMASK write; unmasking may let a pending DMA interrupt in.
+  * @param  priMask: New mask, 0 enables interrupts.
+  */
+void __set_PRIMASK(uint32_t priMask)
+{
+    _primask = priMask;
+    if (priMask != 0 || _inInterrupt)
+        return;
+
+    _unmasks++;
+    if (_quiet || _chunk == NULL || Random_Below(4) != 0)
+        return;
+
+    uint16_t length = _chunkLength;
+
+    _inInterrupt = 1;
+    Finish_Transfer(Random_Below(32) == 0);
+    _inInterrupt = 0;
+    if (_unmasks == 1)
+        _releasedEarly += length;
+}
+
+/**
+  * @brief  Simulated DMA start: checks the chunk and takes ownership of it.
+  * @param  uart: Must be the bound handle.
+  * @param  data: Start of the chunk inside the ring.
+  * @param  len:  Chunk length.
+  * @retval HAL_OK if started, HAL_BUSY when the simulated UART refuses.
+  */
+HAL_StatusTypeDef NEX_Link_Start_Transmit(UART_HandleTypeDef *uart, const uint8_t *data, uint16_t len)
+{
+    if (uart != &_uart || _chunk != NULL || len == 0 || (_primask == 0 && !_inInterrupt))
+        _model.violations++;    // Wrong handle, double start, empty chunk or unmasked caller
+    if ((int32_t)(_tick - _pauseEnd) < 0)
+        _model.violations++;    // Started while paused
+
+    if (Random_Below(16) == 0) {
+        _model.refusals++;
+        return HAL_BUSY;
+    }
+
+    if (_ring == NULL)
+        _ring = data;           // The first chunk after init starts at offset 0
+    if (data < _ring || data + len > _ring + NEX_LINK_TX_QUEUE_SIZE)
+        _model.violations++;    // Outside the ring
+    if (_lastChunk != NULL && data < _lastChunk && !_drained)
+        _model.wraps++;         // Not a restart of an empty queue, so a wrap-skip
+
+    _lastChunk = data;
+    _drained = 0;
+    _chunk = data;
+    _chunkLength = len;
+    _model.transfers++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  xorshift32 pseudo-random generator, reproducible from the seed.
+  * @retval Next pseudo-random value.
+  */
+static uint32_t Random(void)
+{
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
+
+/**
+  * @brief  Returns a pseudo-random value below limit.
+  * @param  limit: Exclusive upper bound, > 0.
+  * @retval 0..limit-1.
+  */
+static uint32_t Random_Below(uint32_t limit)
+{
+    return Random() % limit;
+}
+
+/**
+  * @brief  Ends the transfer in flight and compares its bytes with the model.
+  * @param  error: 1 to report a DMA error (chunk dropped), 0 for completion.
+  * @retval None
+  * @note   Runs as the simulated ISR; the next chunk may start inside.
+  */
+static void Finish_Transfer(uint8_t error)
+{
+    if (_chunk == NULL)
+        return;
+
+    const uint8_t *chunk = _chunk;
+    uint16_t length = _chunkLength;
+
+    for (uint16_t i = 0; i < length; i++) {
+        if (_fifoOut == _fifoIn + _staged || chunk[i] != _fifo[_fifoOut % LINK_SIM_MODEL_SIZE]) {
+            _model.violations++;    // Reordered, overwritten or invented byte
+            break;
+        }
+        _fifoOut++;
+    }
+    _model.depth -= length;
+    _drained = (_fifoOut == _fifoIn);
+    if (error)
+        _model.errors++;
+
+    _chunk = NULL;      // The callback may start the next chunk right away
+    if (error)
+        NEX_Link_Error_Callback(&_uart);
+    else
+        NEX_Link_TxCplt_Callback(&_uart);
+}
+
+/**
+  * @brief  Writes a block of random length and content and checks the verdict.
+  *
+  *         Most blocks are command-sized; some are sized to the free space
+  *         reported just before, or beyond it, to hit the rejection edge.
+  *
+  * @retval None
+  */
+static void Write_Block(void)
+{
+    uint8_t block[NEX_LINK_TX_QUEUE_SIZE + 8];
+    uint8_t quiet = (Random_Below(4) == 0);
+
+    _quiet = quiet;     // Quiet: the free space stays exact up to the write
+    uint16_t free = NEX_Link_Get_Free();
+    uint32_t shape = Random_Below(10);
+    uint16_t length = (shape < 6) ? 1 + Random_Below(40)
+                    : (shape < 8) ? 1 + Random_Below(200)
+                    : (shape < 9) ? free + Random_Below(2)
+                    :               1 + Random_Below(sizeof(block));
+
+    if (length == 0 || length > sizeof(block))
+        length = 1;
+    for (uint16_t i = 0; i < length; i++)
+        block[i] = (uint8_t)Random();
+
+    uint32_t before = _model.depth;
+
+    // Staged first: the chunk holding the block may complete before the call returns
+    for (uint16_t i = 0; i < length; i++)
+        _fifo[(_fifoIn + i) % LINK_SIM_MODEL_SIZE] = block[i];
+    _staged = length;
+
+    _quiet = quiet;
+    _unmasks = 0;
+    _releasedEarly = 0;
+    HAL_StatusTypeDef status = NEX_Link_Write(block, length);
+    _quiet = 0;
+    _staged = 0;
+
+    if (status == HAL_OK) {
+        _fifoIn += length;
+        if (_fifoIn - _fifoOut > NEX_LINK_TX_QUEUE_SIZE)
+            _model.violations++;    // More queued than the ring holds
+        _model.depth += length;
+        _model.bytesQueued += length;
+
+        uint32_t peak = before - _releasedEarly + length;   // Depth when the write committed
+        if (peak > _model.peakDepth)
+            _model.peakDepth = peak;
+        if (quiet && length > free)
+            _model.violations++;    // Accepted more than the free space reported
+    } else {
+        _model.overflows++;
+        if (length <= free)
+            _model.violations++;    // Rejected a block that fit
+    }
+}
+
+/**
+  * @brief  Compares the queue depth with the model.
+  * @param  where: Phase name for the report.
+  * @retval None
+  */
+static void Check_Depth(const char *where)
+{
+    NEX_Link_Stats stats;
+
+    _quiet = 1;     // An interrupt in between would move the depth
+    NEX_Link_Get_Stats(&stats);
+    _quiet = 0;
+    if (NEX_Link_Get_Depth() != _model.depth || stats.depth != _model.depth) {
+        printf("FAIL %s: depth %u, model %lu\n", where, NEX_Link_Get_Depth(), (unsigned long)_model.depth);
+        _model.violations++;
+        _model.depth = NEX_Link_Get_Depth();    // Report each divergence once
+    }
+}
+
+/**
+  * @brief  Compares the queue counters with the model.
+  * @retval 0 if they match, 1 otherwise.
+  */
+static uint8_t Compare_Stats(void)
+{
+    NEX_Link_Stats stats;
+
+    NEX_Link_Get_Stats(&stats);
+    if (stats.peakDepth == _model.peakDepth && stats.overflows == _model.overflows &&
+        stats.bytesQueued == _model.bytesQueued && stats.transfers == _model.transfers &&
+        stats.errors == _model.errors && stats.pauses == _model.pauses)
+        return 0;
+
+    printf("FAIL stats: peak %u/%lu, overflows %lu/%lu, bytes %lu/%lu, transfers %lu/%lu, "
+           "errors %lu/%lu, pauses %lu/%lu\n",
+           stats.peakDepth, (unsigned long)_model.peakDepth,
+           (unsigned long)stats.overflows, (unsigned long)_model.overflows,
+           (unsigned long)stats.bytesQueued, (unsigned long)_model.bytesQueued,
+           (unsigned long)stats.transfers, (unsigned long)_model.transfers,
+           (unsigned long)stats.errors, (unsigned long)_model.errors,
+           (unsigned long)stats.pauses, (unsigned long)_model.pauses);
+    return 1;
+}
@@ -0,0 +1,402 @@
+/**
+ ******************************************************************************
+ * @file           : nmea_fuzz.c
+ * @brief          : Host fuzz harness for the NMEA stream parser
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Runs nmea_parser.c on the host against a generated receiver stream and
+ * against random noise. Build and run from the project directory:
+ *
+ *   gcc -std=gnu11 -O1 -g -fsanitize=address,undefined -fno-sanitize-recover
+ *       -Itests/stub -Ilibs/Inc tests/nmea_fuzz.c libs/Src/nmea_parser.c
+ *       -o nmea_fuzz
+ *   ./nmea_fuzz [seed] [megabytes]
+ *
+ * The generated stream mixes valid sentences with sentences that are cut
+ * off, too long, have too many fields, a control character or a wrong
+ * checksum, with junk bytes in between. It is fed in one piece, in random
+ * chunks of 1..NMEA_FUZZ_MAX_CHUNK bytes and one byte at a time. Every pass
+ * must report exactly the generated number of valid sentences, checksum
+ * errors and framing errors, and dispatch the same sentences.
+ *
+ * Every dispatched sentence is checked against the bounds of the line
+ * buffer: at most NMEA_MAX_FIELDS fields, every offset inside the buffer and
+ * every field terminated inside it. Writes past _line or offsets[] are
+ * caught by AddressSanitizer, which is why the sanitizers are part of the
+ * build line. The field conversions run on every field as well.
+ *
+ * The throughput of the single-piece pass is printed in MB/s and sentences
+ * per second of host CPU time; NMEA_Parser_Benchmark() gives the numbers on
+ * the target.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NMEA_FUZZ_DEFAULT_MB 4U      /*!< Size of the generated stream */
+#define NMEA_FUZZ_MAX_CHUNK 300U     /*!< Largest random chunk fed at once */
+#define NMEA_FUZZ_MAX_JUNK 8U        /*!< Largest run of junk bytes between sentences */
+#define NMEA_FUZZ_MAX_LINE 160U      /*!< Longest generated line, framing included */
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  Defect built into a generated sentence.
+  */
+typedef enum {
+    FUZZ_VALID = 0,          /*!< Well-formed, upper-case checksum */
+    FUZZ_LOWER_CASE,         /*!< Well-formed, lower-case checksum */
+    FUZZ_BAD_CHECKSUM,       /*!< Checksum does not match */
+    FUZZ_TOO_LONG,           /*!< Body longer than NMEA_MAX_SENTENCE */
+    FUZZ_TOO_MANY_FIELDS,    /*!< More than NMEA_MAX_FIELDS fields */
+    FUZZ_CONTROL,            /*!< Control or non-ASCII byte in the body */
+    FUZZ_CUT_OFF,            /*!< No checksum or line end; next '$' follows */
+    FUZZ_KIND_COUNT
+} Fuzz_Kind;
+
+/**
+  * @brief  Outcome of one pass over a stream.
+  */
+typedef struct {
+    NMEA_Parser_Stats stats; /*!< Parser counters after the pass */
+    uint32_t dispatched;     /*!< Sentences seen by the handler */
+    uint32_t digest;         /*!< FNV-1a over the fields of those sentences */
+    uint32_t violations;     /*!< Sentences breaking the buffer bounds */
+    double seconds;          /*!< CPU time spent in NMEA_Parser_Feed() */
+} Fuzz_Result;
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint32_t _random = 1;         /*!< xorshift32 state */
+static Fuzz_Result _result;          /*!< Pass in progress */
+
+/**
+ * @brief Counters the generated stream must produce.
+ */
+static NMEA_Parser_Stats _expected;
+
+/**
+ * @brief Printable characters used in fields; never '$', '*' or ','.
+ */
+static const char FIELD_CHARACTERS[] = "0123456789.-ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz!#%&()+/:;<=>?@[]^_{|}~";
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup Nmea_Fuzz_Private_Functions
+  * @{
+  */
+static uint32_t Random(void);
+static uint32_t Random_Below(uint32_t limit);
+static size_t Write_Sentence(uint8_t *out, Fuzz_Kind kind);
+static size_t Build_Stream(uint8_t *stream, size_t size);
+static void Fill_Noise(uint8_t *stream, size_t size);
+static void Check_Sentence(const NMEA_Sentence *sentence);
+static void Run_Pass(const uint8_t *stream, size_t size, uint32_t maxChunk);
+static uint8_t Compare_Stats(const char *name, const NMEA_Parser_Stats *stats);
+/**
+  * @}
+  */
+
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : (uint32_t)time(NULL);
+    size_t size = (size_t)((argc > 2) ? strtoul(argv[2], NULL, 0) : NMEA_FUZZ_DEFAULT_MB) << 20;
+    uint8_t *stream = malloc(size + NMEA_FUZZ_MAX_LINE);
+    uint8_t failed = 0;
+
+    if (stream == NULL || size == 0) {
+        fprintf(stderr, "usage: %s [seed] [megabytes > 0]\n", argv[0]);
+        return 2;
+    }
+    _random = (seed != 0) ? seed : 1U;
+    printf("seed %lu, %lu MB\n", (unsigned long)seed, (unsigned long)(size >> 20));
+
+    size_t length = Build_Stream(stream, size);
+
+    Run_Pass(stream, length, 0);
+    Fuzz_Result whole = _result;
+    failed |= Compare_Stats("whole", &whole.stats);
+    printf("whole:  %lu sentences, %.1f MB/s, %.0f sentences/s\n",
+           (unsigned long)whole.dispatched, length / whole.seconds / 1e6,
+           whole.dispatched / whole.seconds);
+
+    Run_Pass(stream, length, NMEA_FUZZ_MAX_CHUNK);
+    failed |= Compare_Stats("chunks", &_result.stats);
+    if (_result.dispatched != whole.dispatched || _result.digest != whole.digest) {
+        printf("FAIL chunks: dispatched different sentences\n");
+        failed = 1;
+    }
+
+    Run_Pass(stream, length, 1);
+    failed |= Compare_Stats("bytes", &_result.stats);
+    if (_result.dispatched != whole.dispatched || _result.digest != whole.digest) {
+        printf("FAIL bytes: dispatched different sentences\n");
+        failed = 1;
+    }
+
+    uint32_t violations = whole.violations + _result.violations;
+
+    Fill_Noise(stream, length);
+    Run_Pass(stream, length, NMEA_FUZZ_MAX_CHUNK);
+    printf("noise:  %lu sentences, %lu checksum errors, %lu framing errors\n",
+           (unsigned long)_result.stats.sentences, (unsigned long)_result.stats.checksumErrors,
+           (unsigned long)_result.stats.framingErrors);
+    violations += _result.violations;
+
+    if (violations != 0) {
+        printf("FAIL %lu sentences outside the line buffer bounds\n", (unsigned long)violations);
+        failed = 1;
+    }
+
+    free(stream);
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
+
+/**
+  * @brief  xorshift32 pseudo-random generator, reproducible from the seed.
+  * @retval Next pseudo-random value.
+  */
+static uint32_t Random(void)
+{
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
+
+/**
+  * @brief  Returns a pseudo-random value below limit.
+  * @param  limit: Exclusive upper bound, > 0.
+  * @retval 0..limit-1.
+  */
+static uint32_t Random_Below(uint32_t limit)
+{
+    return Random() % limit;
+}
+
+/**
+  * @brief  Writes one sentence with the given defect and tallies its outcome.
+  * @param  out:  Destination, at least NMEA_FUZZ_MAX_LINE bytes.
+  * @param  kind: Defect to build in.
+  * @retval Bytes written.
+  */
+static size_t Write_Sentence(uint8_t *out, Fuzz_Kind kind)
+{
+    static const char *const ADDRESSES[] = { "GNRMC", "GPGGA", "GNGSA", "GLGSA", "GNVTG", "GPGSV", "GNTXT" };
+    char body[NMEA_FUZZ_MAX_LINE];
+    size_t length = 0;
+    uint8_t checksum = 0;
+
+    memcpy(body, ADDRESSES[Random_Below(sizeof(ADDRESSES) / sizeof(ADDRESSES[0]))], NMEA_ADDRESS_SIZE);
+    length = NMEA_ADDRESS_SIZE;
+
+    uint32_t separators = (kind == FUZZ_TOO_MANY_FIELDS) ? NMEA_MAX_FIELDS + Random_Below(8)
+                                                        : Random_Below(NMEA_MAX_FIELDS);
+    uint32_t fieldSize = (kind == FUZZ_TOO_MANY_FIELDS) ? 2U : 9U;    // Too many fields still fit
+    size_t limit = (kind == FUZZ_TOO_LONG) ? NMEA_MAX_SENTENCE + 1U + Random_Below(40)
+                                           : NMEA_MAX_SENTENCE;
+
+    for (uint32_t i = 0; i < separators && length < limit; i++) {
+        body[length++] = ',';
+        for (uint32_t n = Random_Below(fieldSize); n > 0 && length < limit; n--)
+            body[length++] = FIELD_CHARACTERS[Random_Below(sizeof(FIELD_CHARACTERS) - 1U)];
+    }
+    while (kind == FUZZ_TOO_LONG && length < limit)
+        body[length++] = FIELD_CHARACTERS[Random_Below(sizeof(FIELD_CHARACTERS) - 1U)];
+    if (kind == FUZZ_CONTROL) {
+        uint8_t bad = (uint8_t)Random_Below(64);
+        body[1U + Random_Below((uint32_t)length - 1U)] = (char)((bad < 32U) ? bad : 0x7FU + bad);
+    }
+
+    for (size_t i = 0; i < length; i++)
+        checksum ^= (uint8_t)body[i];
+    if (kind == FUZZ_BAD_CHECKSUM)
+        checksum ^= (uint8_t)(1U + Random_Below(255));
+
+    size_t written = 0;
+    out[written++] = '$';
+    memcpy(&out[written], body, length);
+    written += length;
+
+    if (kind != FUZZ_CUT_OFF) {
+        written += (size_t)sprintf((char *)&out[written], (kind == FUZZ_LOWER_CASE) ? "*%02x" : "*%02X", checksum);
+        switch (Random_Below(3)) {
+        case 0:  out[written++] = '\r'; out[written++] = '\n'; break;
+        case 1:  out[written++] = '\n'; break;
+        default: out[written++] = '\r'; break;
+        }
+    }
+
+    switch (kind) {
+    case FUZZ_VALID:
+    case FUZZ_LOWER_CASE:
+        _expected.sentences++;
+        break;
+    case FUZZ_BAD_CHECKSUM:
+        _expected.checksumErrors++;
+        break;
+    default:
+        _expected.framingErrors++;
+        break;
+    }
+    return written;
+}
+
+/**
+  * @brief  Generates a receiver stream: mostly valid sentences, every defect
+  *         of Fuzz_Kind, and junk without '$' between sentences.
+  * @param  stream: Destination, size + NMEA_FUZZ_MAX_LINE bytes.
+  * @param  size:   Approximate stream length.
+  * @retval Bytes generated.
+  */
+static size_t Build_Stream(uint8_t *stream, size_t size)
+{
+    size_t length = 0;
+    Fuzz_Kind kind = FUZZ_VALID;
+
+    memset(&_expected, 0, sizeof(_expected));
+
+    while (length < size - NMEA_FUZZ_MAX_LINE) {
+        if (kind != FUZZ_CUT_OFF) {     // A cut-off sentence must end at the next '$'
+            for (uint32_t n = Random_Below(NMEA_FUZZ_MAX_JUNK + 1U); n > 0; n--) {
+                uint8_t junk;
+                do {
+                    junk = (uint8_t)Random();
+                } while (junk == '$');
+                stream[length++] = junk;
+            }
+        }
+
+        uint32_t roll = Random_Below(16);
+        kind = (roll < (uint32_t)FUZZ_KIND_COUNT) ? (Fuzz_Kind)roll : FUZZ_VALID;
+        length += Write_Sentence(&stream[length], kind);
+    }
+
+    if (kind == FUZZ_CUT_OFF)
+        length += Write_Sentence(&stream[length], FUZZ_VALID);   // Ends the last one
+    return length;
+}
+
+/**
+  * @brief  Overwrites the stream with noise, biased to the characters that
+  *         drive the state machine.
+  * @param  stream: Buffer to fill.
+  * @param  size:   Bytes to fill.
+  * @retval None
+  */
+static void Fill_Noise(uint8_t *stream, size_t size)
+{
+    static const char SYNTAX[] = "$$*,,,\r\n0123456789ABCDEFabcdef";
+
+    for (size_t i = 0; i < size; i++)
+        stream[i] = (Random_Below(3) == 0) ? (uint8_t)SYNTAX[Random_Below(sizeof(SYNTAX) - 1U)]
+                                           : (uint8_t)Random();
+}
+
+/**
+  * @brief  Handler registered for every address ("-----"): checks the
+  *         sentence against the line buffer bounds, runs the conversions on
+  *         each field and folds the fields into the digest.
+  * @param  sentence: Dispatched sentence.
+  * @retval None
+  */
+static void Check_Sentence(const NMEA_Sentence *sentence)
+{
+    int32_t value;
+
+    _result.dispatched++;
+
+    if (sentence->fields == 0 || sentence->fields > NMEA_MAX_FIELDS) {
+        _result.violations++;
+        return;
+    }
+
+    for (uint8_t i = 0; i < sentence->fields; i++) {
+        uint8_t offset = sentence->offsets[i];
+
+        if (offset > NMEA_MAX_SENTENCE || (i > 0 && offset <= sentence->offsets[i - 1U]) ||
+            memchr(&sentence->text[offset], '\0', NMEA_MAX_SENTENCE + 1U - offset) == NULL) {
+            _result.violations++;
+            return;
+        }
+
+        const char *field = NMEA_Parser_Field(sentence, i);
+        NMEA_Parser_To_Fixed(field, (uint8_t)(i % 7U), &value);
+        NMEA_Parser_To_Coordinate(field, NMEA_Parser_Field(sentence, (uint8_t)(i + 1U)), &value);
+
+        for (; *field != '\0'; field++)
+            _result.digest = (_result.digest ^ (uint8_t)*field) * 16777619UL;
+        _result.digest = (_result.digest ^ ',') * 16777619UL;
+    }
+
+    if (NMEA_Parser_Field(sentence, sentence->fields)[0] != '\0')
+        _result.violations++;           // Past the last field must read as empty
+}
+
+/**
+  * @brief  Feeds a stream to a freshly initialised parser.
+  * @param  stream:   Bytes to feed.
+  * @param  size:     Number of bytes.
+  * @param  maxChunk: 0 for the largest chunks NMEA_Parser_Feed() takes,
+  *                   otherwise random chunks of 1..maxChunk bytes.
+  * @retval None, the outcome is left in _result.
+  */
+static void Run_Pass(const uint8_t *stream, size_t size, uint32_t maxChunk)
+{
+    memset(&_result, 0, sizeof(_result));
+    _result.digest = 2166136261UL;
+
+    NMEA_Parser_Init();
+    NMEA_Parser_Register_Handler("-----", Check_Sentence);
+
+    clock_t start = clock();
+    for (size_t offset = 0; offset < size;) {
+        size_t chunk = (maxChunk == 0) ? UINT16_MAX : 1U + Random_Below(maxChunk);
+
+        if (chunk > size - offset)
+            chunk = size - offset;
+        NMEA_Parser_Feed(&stream[offset], (uint16_t)chunk);
+        offset += chunk;
+    }
+    _result.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (_result.seconds <= 0.0)
+        _result.seconds = 1e-9;
+
+    NMEA_Parser_Get_Stats(&_result.stats);
+}
+
+/**
+  * @brief  Compares the counters of a pass with the generated stream.
+  * @param  name:  Pass name for the report.
+  * @param  stats: Counters after the pass.
+  * @retval 0 if they match, 1 otherwise.
+  */
+static uint8_t Compare_Stats(const char *name, const NMEA_Parser_Stats *stats)
+{
+    if (stats->sentences == _expected.sentences && stats->checksumErrors == _expected.checksumErrors &&
+        stats->framingErrors == _expected.framingErrors && _result.dispatched == _expected.sentences)
+        return 0;
+
+    printf("FAIL %s: sentences %lu/%lu, checksum errors %lu/%lu, framing errors %lu/%lu, dispatched %lu\n",
+           name, (unsigned long)stats->sentences, (unsigned long)_expected.sentences,
+           (unsigned long)stats->checksumErrors, (unsigned long)_expected.checksumErrors,
+           (unsigned long)stats->framingErrors, (unsigned long)_expected.framingErrors,
+           (unsigned long)_result.dispatched);
+    return 1;
+}
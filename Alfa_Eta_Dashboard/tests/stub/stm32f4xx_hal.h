@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file           : stm32f4xx_hal.h
+ * @brief          : Host stand-in for the HAL header, for the tests only
+ ******************************************************************************
+ * @author         : Hamza Enes Balahoroglu
+ * @version        : v1.0
+ * @date           : 15.10.2026
+ *
+ * @note
+ * Provides just what the hardware-independent modules (nmea_parser.c) and
+ * the TX queue (nex_link.c) use, so they compile with a host compiler. Put
+ * this directory before libs/Inc on the include path; it is not part of the
+ * firmware build.
+ *
+ * The tick, the interrupt mask and the UART functions are only declared.
+ * A harness that links nex_link.c defines them, which is where it simulates
+ * the DMA and lets interrupts in.
+ *
+ *           _  __        ______ _______
+ *     /\   | |/ _|      |  ____|__   __|/\
+ *    /  \  | | |_ __ _  | |__     | |  /  \
+ *   / /\ \ | |  _/ _` | |  __|    | | / /\ \
+ *  / ____ \| | || (_| | | |____   | |/ ____ \
+ * /_/    \_\_|_| \__,_| |______|  |_/_/    \_\
+ ******************************************************************************
+ */
+
+#ifndef STM32F4XX_HAL_STUB
+#define STM32F4XX_HAL_STUB
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __weak __attribute__((weak))
+
+/**
+ * @brief HAL status, same values as stm32f4xx_hal_def.h.
+ */
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/**
+ * @brief UART states used by the library, same values as stm32f4xx_hal_uart.h.
+ */
+typedef enum {
+    HAL_UART_STATE_READY   = 0x20U,
+    HAL_UART_STATE_BUSY_TX = 0x21U
+} HAL_UART_StateTypeDef;
+
+/**
+ * @brief UART handle, reduced to the members the library reads.
+ */
+typedef struct {
+    struct {
+        uint32_t BaudRate;
+    } Init;
+    volatile HAL_UART_StateTypeDef gState;
+    volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+uint32_t HAL_GetTick(void);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+
+#endif // STM32F4XX_HAL_STUB